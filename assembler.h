@@ -25,4 +25,6 @@
 #include "assembler/output/output.h"
 #include "assembler/parser/parser.h"
 #include "assembler/preprocessor/preprocessor.h"
+#include "assembler/utils/bounded_queue.h"
 #include "assembler/utils/include_chain.h"
+#include "assembler/utils/stage.h"
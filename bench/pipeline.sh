@@ -0,0 +1,64 @@
+#!/bin/bash
+#
+# Reaver Project Assembler License
+#
+# Copyright © 2014 Michał "Griwes" Dominiak
+#
+# This software is provided 'as-is', without any express or implied
+# warranty. In no event will the authors be held liable for any damages
+# arising from the use of this software.
+#
+# Permission is granted to anyone to use this software for any purpose,
+# including commercial applications, and to alter it and redistribute it
+# freely, subject to the following restrictions:
+#
+# 1. The origin of this software must not be misrepresented; you must not
+#    claim that you wrote the original software. If you use this software
+#    in a product, an acknowledgment in the product documentation is required.
+# 2. Altered source versions must be plainly marked as such, and must not be
+#    misrepresented as being the original software.
+# 3. This notice may not be removed or altered from any source distribution.
+#
+# Compares wall time and peak RSS of a pipelined run of rasm (each stage on its own thread, bounded queues between them)
+# against the batch run (--pipeline-depth 0, the default), on a generated source file.
+#
+# usage: bench/pipeline.sh [number of lines] [additional rasm options...]
+
+set -e
+
+lines=${1:-1000000}
+shift || true
+
+rasm=${RASM:-./rasm}
+source=$(mktemp --suffix=.asm)
+trap 'rm -f "$source" "$source.out"' EXIT
+
+awk -v n="$lines" 'BEGIN {
+    print "bits 64"
+    print "section .text"
+    for (i = 0; i < n; ++i)
+    {
+        if (i % 64 == 0)
+        {
+            printf "label%d:\n", i
+        }
+        print "    add rax, rbx"
+    }
+}' > "$source"
+
+echo "$lines lines, $(du -h "$source" | cut -f1) of source"
+
+for depth in 0 1024
+do
+    printf "%-24s" "--pipeline-depth $depth:"
+
+    if [ -x /usr/bin/time ]
+    then
+        /usr/bin/time -f "%e s wall, %M KiB peak RSS" "$rasm" "$source" -o "$source.out" --pipeline-depth $depth "$@" 2>&1 \
+            | tail -n 1
+    else
+        # no GNU time, so no peak RSS either
+        TIMEFORMAT="%R s wall"
+        time "$rasm" "$source" -o "$source.out" --pipeline-depth $depth "$@" > /dev/null 2>&1 || true
+    fi
+done
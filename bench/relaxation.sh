@@ -0,0 +1,58 @@
+#!/bin/bash
+#
+# Reaver Project Assembler License
+#
+# Copyright © 2014 Michał "Griwes" Dominiak
+#
+# This software is provided 'as-is', without any express or implied
+# warranty. In no event will the authors be held liable for any damages
+# arising from the use of this software.
+#
+# Permission is granted to anyone to use this software for any purpose,
+# including commercial applications, and to alter it and redistribute it
+# freely, subject to the following restrictions:
+#
+# 1. The origin of this software must not be misrepresented; you must not
+#    claim that you wrote the original software. If you use this software
+#    in a product, an acknowledgment in the product documentation is required.
+# 2. Altered source versions must be plainly marked as such, and must not be
+#    misrepresented as being the original software.
+# 3. This notice may not be removed or altered from any source distribution.
+#
+#
+# Reports the output size of -O0 (every branch near) and -O1 (branches relaxed) on a generated source file full of
+# conditional branches of random reach, together with the relaxation statistics of the -O1 run.
+#
+# usage: bench/relaxation.sh [number of branches] [additional rasm options...]
+
+set -e
+
+branches=${1:-100000}
+shift || true
+
+rasm=${RASM:-./rasm}
+source=$(mktemp --suffix=.asm)
+trap 'rm -f "$source" "$source.out"' EXIT
+
+awk -v n="$branches" 'BEGIN {
+    srand(1)
+    print "bits 64"
+    print "section .text"
+    for (i = 0; i < n; ++i)
+    {
+        target = i + int(rand() * 96) - 48
+        target = target < 0 ? 0 : target >= n ? n - 1 : target
+        printf "label%d:\n", i
+        printf "    jne label%d\n", target
+        print "    add rax, rbx"
+    }
+}' > "$source"
+
+echo "$branches branches, $(du -h "$source" | cut -f1) of source"
+
+for level in 0 1
+do
+    printf "%-6s" "-O$level:"
+    "$rasm" "$source" -o "$source.out" -O$level --stats "$@" 2>&1 | grep relaxation || echo
+    echo "      $(stat -c %s "$source.out") bytes of output"
+done
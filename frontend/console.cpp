@@ -21,6 +21,8 @@
  **/
 
 #include <iostream>
+#include <algorithm>
+#include <thread>
 
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
@@ -55,6 +57,9 @@ reaver::assembler::console_frontend::console_frontend(int argc, char ** argv, er
         ("output,o", boost::program_options::value<std::string>()->default_value(""), "specify output file")
         ("preprocess-only,E", "preprocess only")
         ("assemble-only,s", "assemble only, do not link")
+        ("entry,e", boost::program_options::value<std::string>()->default_value("_start"), "specify the symbol the linked "
+            "executable starts at")
+        ("debug,g", "generate DWARF line information, mapping the code back to the lines of the source files (ELF only)")
         ("include-dir,I", boost::program_options::value<std::vector<std::string>>(&_include_paths)->composing(), "specify additional"
             " include directories")
         ("include,i", boost::program_options::value<std::vector<std::string>>()->composing(), "specify automatically included file")
@@ -65,7 +70,18 @@ reaver::assembler::console_frontend::console_frontend(int argc, char ** argv, er
         ("format,f", boost::program_options::value<std::string>()->default_value("elf64"), "specify format; currently "
             "supported:\n- binary (flat)\n- elf32\n- elf64")
         ("target,t", boost::program_options::value<std::string>()->default_value("x86_64-none-elf"), "specify target in "
-            "triple format; currently supported:\n- i(X)86-none-elf\n- i(X)86-linux-elf\n- x86_64-none-elf\n- x86_64-linux-elf");
+            "triple format; currently supported:\n- i(X)86-none-elf\n- i(X)86-linux-elf\n- x86_64-none-elf\n- x86_64-linux-elf")
+        ("pipeline-depth", boost::program_options::value<std::size_t>(&_pipeline_depth), "set number of lines buffered between "
+            "preprocessor, parser and generator, each running on its own thread; 0 runs them one after another (default: 0; the "
+            "generator still waits for the whole source, so pipelining doesn't bound memory yet)")
+        ("jobs,j", boost::program_options::value<std::size_t>(&_jobs), "set number of threads encoding instructions; 0 uses "
+            "one per hardware thread (default: 1)")
+        ("cache-dir", boost::program_options::value<std::string>()->default_value(""), "cache assembled objects in the given "
+            "directory, keyed by the preprocessed source and the options affecting the output; the directory can be shared by "
+            "concurrent runs")
+        ("visibility", boost::program_options::value<std::string>()->default_value("default"), "set visibility of global "
+            "symbols not given one in the source (like `global name:hidden` does); one of:\n- default\n- internal\n- hidden\n"
+            "- protected");
 
     boost::program_options::options_description errors("Error and optimization options");
     errors.add_options()
@@ -74,7 +90,12 @@ reaver::assembler::console_frontend::console_frontend(int argc, char ** argv, er
         ("Wno-long-mode-ss-write", boost::program_options::value<bool>(&_no_ss_warning)->implicit_value(true), " disable warning"
             " about write to segment register being ignored in 64 bit mode, if the segment register is SS (i(X)86 and x86_64 only)")
         ("optimizations,O", boost::program_options::value<int>(&_opt), "set optimization level; supported levels:\n"
-            "- O0 - disable all optimizations\n- O1 - enable space optimizations (default)\n- O2 - enable additional optimizations");
+            "- O0 - disable all optimizations\n- O1 - enable space optimizations (default)\n- O2 - enable additional optimizations")
+        ("stats", boost::program_options::value<bool>(&_stats)->implicit_value(true), " report statistics of the generation "
+            "passes, like the number of branch relaxation passes")
+        ("function-sections", boost::program_options::value<bool>(&_function_sections)->implicit_value(true), " place every "
+            "global label of `.text`, along with the code following it, in a section of its own, `.text.<label>`, so that the "
+            "linker can drop the unused ones (ELF only)");
 
     boost::program_options::options_description preprocessor("Preprocessor options");
     preprocessor.add_options()
@@ -82,10 +103,12 @@ reaver::assembler::console_frontend::console_frontend(int argc, char ** argv, er
 
     boost::program_options::options_description hidden("Hidden");
     hidden.add_options()
-        ("input", boost::program_options::value<std::string>(), "specify input file");
+        ("input", boost::program_options::value<std::string>(), "specify input file; `-` reads the standard input")
+        ("objects", boost::program_options::value<std::vector<std::string>>()->composing(), "specify ELF64 relocatable "
+            "objects to link with the assembled one");
 
     boost::program_options::positional_options_description pod;
-    pod.add("input", 1);
+    pod.add("input", 1).add("objects", -1);
 
     boost::program_options::options_description options;
     options.add(config).add(hidden).add(general).add(errors).add(preprocessor);
@@ -103,7 +126,7 @@ reaver::assembler::console_frontend::console_frontend(int argc, char ** argv, er
         std::cout << version_string << '\n';
 
         std::cout << "Usage:\n";
-        std::cout << "  rasm [options] <input file> [options]\n\n";
+        std::cout << "  rasm [options] <input file> [objects to link with] [options]\n\n";
 
         std::stringstream ss;
         ss << general << std::endl << config << std::endl << errors << std::endl << preprocessor;
@@ -136,7 +159,7 @@ reaver::assembler::console_frontend::console_frontend(int argc, char ** argv, er
         throw std::move(engine);
     }
 
-    _input.open(_input_name, std::ios::in);
+    _input = utils::mapped_file{ _input_name };
     if (!_input)
     {
         engine.push(exception(logger::error) << "failed to open input file `"  << _input_name << ".");
@@ -148,13 +171,6 @@ reaver::assembler::console_frontend::console_frontend(int argc, char ** argv, er
         _variables.at("output").value() = boost::any{ boost::filesystem::path{ _input_name }.replace_extension(".out").string() };
     }
 
-    _output.open(_variables["output"].as<std::string>(), std::ios::out | std::ios::binary);
-    if (!_output)
-    {
-        engine.push(exception(logger::error) << "failed to open output file `" << _variables["output"].as<std::string>() << ".");
-        throw std::move(engine);
-    }
-
     if (_variables.count("preprocess-only"))
     {
         _prep_only = true;
@@ -171,6 +187,17 @@ reaver::assembler::console_frontend::console_frontend(int argc, char ** argv, er
         throw std::move(engine);
     }
 
+    if (_variables.count("objects"))
+    {
+        _objects = _variables.at("objects").as<std::vector<std::string>>();
+    }
+
+    if (!_objects.empty() && (_asm_only || _prep_only || _variables["format"].as<std::string>() == "binary"))
+    {
+        engine.push(exception(logger::error) << "objects can only be given when linking an executable.");
+        throw std::move(engine);
+    }
+
     _target = _variables["target"].as<std::string>();
 
     if (_target.arch() >= arch::i386 && _target.arch() <= arch::x86_64 && _variables["syntax"].as<std::string>() == "")
@@ -191,12 +218,56 @@ reaver::assembler::console_frontend::console_frontend(int argc, char ** argv, er
         _opt = _variables.at("optimizations").as<int>();
     }
 
+    if (_variables.count("stats"))
+    {
+        _stats = _variables.at("stats").as<bool>();
+    }
+
+    if (_variables.count("debug"))
+    {
+        _debug_info = true;
+    }
+
+    if (_variables.count("function-sections"))
+    {
+        _function_sections = _variables.at("function-sections").as<bool>();
+    }
+
+    auto visibility = _variables["visibility"].as<std::string>();
+
+    if (visibility == "internal" || visibility == "hidden" || visibility == "protected")
+    {
+        _visibility = visibility == "internal" ? symbol_visibilities::internal_visibility : visibility == "hidden"
+            ? symbol_visibilities::hidden_visibility : symbol_visibilities::protected_visibility;
+    }
+
+    else if (visibility != "default")
+    {
+        engine.push(exception(logger::error) << "unknown visibility `" << visibility << "`.");
+        throw std::move(engine);
+    }
+
     if (_opt > 2)
     {
         engine.push(exception(logger::warning) << "not supported optimization level requested; changing to 2.");
         _opt = 2;
     }
 
+    if (_variables.count("pipeline-depth"))
+    {
+        _pipeline_depth = _variables.at("pipeline-depth").as<std::size_t>();
+    }
+
+    if (_variables.count("jobs"))
+    {
+        _jobs = _variables.at("jobs").as<std::size_t>();
+    }
+
+    if (!_jobs)
+    {
+        _jobs = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
     auto chain = std::make_shared<utils::include_chain>("<command line>");
     for (const auto & value : _variables)
     {
@@ -217,7 +288,7 @@ reaver::assembler::file reaver::assembler::console_frontend::open_file(std::stri
     {
         if (boost::filesystem::is_regular_file(filename))
         {
-            std::ifstream ret{ filename, std::ios::in };
+            utils::mapped_file ret{ filename };
 
             if (!ret)
             {
@@ -237,7 +308,7 @@ reaver::assembler::file reaver::assembler::console_frontend::open_file(std::stri
     {
         if (boost::filesystem::is_regular_file(path + "/" + filename))
         {
-            std::ifstream ret{ path + "/" + filename, std::ios::in };
+            utils::mapped_file ret{ path + "/" + filename };
 
             if (!ret)
             {
@@ -29,6 +29,8 @@
 
 #include "frontend.h"
 #include "../preprocessor/define.h"
+#include "../preprocessor/source_buffer.h"
+#include "../parser/symbol_table.h"
 
 namespace reaver
 {
@@ -70,14 +72,14 @@ namespace reaver
                 return _variables["format"].as<std::string>();
             }
 
-            virtual std::istream & input() const override
+            virtual utils::mapped_file & input() const override
             {
                 return _input;
             }
 
-            virtual std::ostream & output() const override
+            virtual std::string output_name() const override
             {
-                return _output;
+                return _variables["output"].as<std::string>();
             }
 
             virtual std::string input_name() const override
@@ -85,6 +87,16 @@ namespace reaver
                 return _input_name;
             }
 
+            virtual const std::vector<std::string> & objects() const override
+            {
+                return _objects;
+            }
+
+            virtual std::string entry() const override
+            {
+                return _variables["entry"].as<std::string>();
+            }
+
             virtual std::vector<file> & default_includes() const override
             {
                 return _default_includes;
@@ -92,6 +104,16 @@ namespace reaver
 
             virtual file open_file(std::string) const override;
 
+            virtual source_buffer & sources() const override
+            {
+                return _sources;
+            }
+
+            virtual symbol_table & symbols() const override
+            {
+                return _symbols;
+            }
+
             virtual const std::map<std::string, std::shared_ptr<define>> & defines() const override
             {
                 return _defines;
@@ -102,6 +124,46 @@ namespace reaver
                 return _werror ? logger::error : logger::warning;
             }
 
+            virtual std::size_t pipeline_depth() const override
+            {
+                return _pipeline_depth;
+            }
+
+            virtual std::size_t jobs() const override
+            {
+                return _jobs;
+            }
+
+            virtual int optimization_level() const override
+            {
+                return _opt;
+            }
+
+            virtual bool statistics() const override
+            {
+                return _stats;
+            }
+
+            virtual bool function_sections() const override
+            {
+                return _function_sections;
+            }
+
+            virtual bool debug_info() const override
+            {
+                return _debug_info;
+            }
+
+            virtual symbol_visibilities default_visibility() const override
+            {
+                return _visibility;
+            }
+
+            virtual std::string cache_directory() const override
+            {
+                return _variables["cache-dir"].as<std::string>();
+            }
+
         private:
             boost::program_options::variables_map _variables;
             bool _prep_only = false;
@@ -110,12 +172,20 @@ namespace reaver
             bool _werror = false;
             bool _no_ss_warning = false;
             int _opt = 1;
+            bool _stats = false;
+            bool _function_sections = false;
+            bool _debug_info = false;
+            symbol_visibilities _visibility = symbol_visibilities::default_visibility;
+            std::size_t _pipeline_depth = 0;
+            std::size_t _jobs = 1;
 
-            mutable std::ifstream _input;
-            mutable std::ofstream _output;
+            mutable utils::mapped_file _input;
 
             std::string _input_name;
+            std::vector<std::string> _objects;
             mutable std::vector<file> _default_includes;
+            mutable source_buffer _sources;
+            mutable symbol_table _symbols;
             std::vector<std::string> _include_paths;
 
             std::map<std::string, std::shared_ptr<define>> _defines;
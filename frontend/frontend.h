@@ -22,7 +22,7 @@
 
 #pragma once
 
-#include <fstream>
+#include <ostream>
 #include <vector>
 #include <map>
 #include <memory>
@@ -30,22 +30,28 @@
 #include <reaver/logger.h>
 #include <reaver/target.h>
 
+#include "../utils/mapped_file.h"
+#include "../parser/symbol_table.h"
+
 namespace reaver
 {
     namespace assembler
     {
         class define;
+        class source_buffer;
+
+        extern const char * version_string;
 
         struct file
         {
             file(file &&) = default;
 
-            file(std::string n, std::ifstream && str) : name{ std::move(n) }, stream{ std::move(str) }
+            file(std::string n, utils::mapped_file && c) : name{ std::move(n) }, contents{ std::move(c) }
             {
             }
 
             std::string name;
-            std::ifstream stream;
+            utils::mapped_file contents;
         };
 
         class frontend
@@ -61,17 +67,52 @@ namespace reaver
             virtual ::reaver::target::triple target() const = 0;
             virtual std::string format() const = 0;
 
-            virtual std::istream & input() const = 0;
-            virtual std::ostream & output() const = 0;
+            // the input is meant to be moved into the source buffer by the preprocessor
+            virtual utils::mapped_file & input() const = 0;
+            // outputs open the file themselves, so that they can write it the way that suits them
+            virtual std::string output_name() const = 0;
 
             virtual std::string input_name() const = 0;
+            // relocatable objects linked into the executable along with the assembled one
+            virtual const std::vector<std::string> & objects() const = 0;
+            // the symbol the linked executable starts at
+            virtual std::string entry() const = 0;
             virtual std::vector<file> & default_includes() const = 0;
 
             virtual file open_file(std::string) const = 0;
 
+            // all the source text of this run
+            virtual source_buffer & sources() const = 0;
+
+            // all the symbol names of this run
+            virtual symbol_table & symbols() const = 0;
+
             virtual const std::map<std::string, std::shared_ptr<define>> & defines() const = 0;
 
             virtual logger::level warning_level() const = 0;
+
+            // number of items buffered between pipelined stages; 0 means the stages are run one after another
+            virtual std::size_t pipeline_depth() const = 0;
+
+            // number of threads encoding instructions
+            virtual std::size_t jobs() const = 0;
+
+            virtual int optimization_level() const = 0;
+
+            // whether to report statistics of the generation passes
+            virtual bool statistics() const = 0;
+
+            // whether every global label of `.text` starts a section of its own
+            virtual bool function_sections() const = 0;
+
+            // whether to describe the source lines of the code in DWARF debugging sections
+            virtual bool debug_info() const = 0;
+
+            // the visibility of global symbols defined without one
+            virtual symbol_visibilities default_visibility() const = 0;
+
+            // where assembled objects are cached between runs; empty when caching is off
+            virtual std::string cache_directory() const = 0;
         };
     }
 }
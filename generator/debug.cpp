@@ -0,0 +1,294 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include <map>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "debug.h"
+#include "dwarf.h"
+#include "../preprocessor/source_buffer.h"
+
+namespace
+{
+    // line number program opcodes, from the DWARF standard
+    enum _line_opcodes : std::uint8_t
+    {
+        _extended = 0x00,
+        _advance_pc = 0x02,
+        _advance_line = 0x03,
+        _set_file = 0x04,
+        _end_sequence = 0x01,       // extended
+        _set_address = 0x02         // extended
+    };
+
+    // the parameters of the special opcodes; the usual ones, favoring short steps forward
+    constexpr std::int64_t _line_base = -5;
+    constexpr std::uint8_t _line_range = 14;
+    constexpr std::uint8_t _opcode_base = 13;
+    constexpr std::uint8_t _standard_lengths[_opcode_base - 1] = { 0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1 };
+
+    constexpr std::uint16_t _version = 4;
+
+    // the tag, the attributes and the forms of the only debugging information entry
+    constexpr std::uint8_t _compile_unit = 0x11;
+    constexpr std::uint8_t _attributes[] = {
+        0x10, 0x17,     // stmt_list, sec_offset
+        0x11, 0x01,     // low_pc, addr
+        0x55, 0x17,     // ranges, sec_offset
+        0x03, 0x08,     // name, string
+        0x1b, 0x08,     // comp_dir, string
+        0x25, 0x08,     // producer, string
+        0x13, 0x05,     // language, data2
+        0, 0
+    };
+
+    constexpr std::uint16_t _assembler_language = 0x8001;
+
+    // a field to be relocated against the start of a section, or left as it is when there's no such section
+    void _address(reaver::assembler::section & target, std::uint32_t section, std::uint64_t offset, std::uint8_t size)
+    {
+        target.fixups().push_back({ target.size(), static_cast<std::int64_t>(offset), reaver::assembler::no_symbol, size,
+            reaver::assembler::fixup::kinds::absolute, section });
+        reaver::assembler::dwarf::put(target.bytes(), 0, size);
+    }
+
+    // finishes a unit started at `start` with its length field left zeroed
+    void _close(std::vector<std::uint8_t> & bytes, std::uint64_t start)
+    {
+        auto length = bytes.size() - start - 4;
+
+        for (std::uint8_t i = 0; i < 4; ++i)
+        {
+            bytes[start + i] = static_cast<std::uint8_t>(length >> (8 * i));
+        }
+    }
+}
+
+reaver::assembler::line_statistics reaver::assembler::describe_lines(reaver::assembler::module & output,
+    const std::vector<reaver::assembler::line_rows> & rows, const reaver::assembler::frontend & front, bool long_mode)
+{
+    line_statistics ret;
+
+    const auto & sources = front.sources();
+    std::uint8_t address_size = long_mode ? 8 : 4;
+
+    // the rows are resolved to files and lines first, so that the header can list the files
+    std::map<std::string, std::uint64_t> files;
+    std::vector<std::string> names;
+    std::vector<std::vector<std::pair<std::uint64_t, std::uint64_t>>> resolved(rows.size());
+
+    for (std::uint32_t section = 0; section < rows.size(); ++section)
+    {
+        const auto & offsets = rows[section].offsets;
+
+        for (std::size_t i = 0; i < offsets.size(); ++i)
+        {
+            // a statement without any code shares its offset with the next one
+            if (i + 1 < offsets.size() && offsets[i + 1] == offsets[i])
+            {
+                continue;
+            }
+
+            auto location = rows[section].locations[i];
+            auto file = files.emplace(sources.file_name(location), files.size() + 1);
+
+            if (file.second)
+            {
+                names.push_back(file.first->first);
+            }
+
+            resolved[section].emplace_back(file.first->second, sources.line_number(location));
+        }
+    }
+
+    if (names.empty())
+    {
+        return ret;
+    }
+
+    ret.files = names.size();
+
+    auto line_index = output.section_index(".debug_line");
+    auto abbrev_index = output.section_index(".debug_abbrev");
+    auto info_index = output.section_index(".debug_info");
+    auto ranges_index = output.section_index(".debug_ranges");
+
+    auto & line = output.sections()[line_index];
+    auto & bytes = line.bytes();
+    auto start = bytes.size();
+
+    // the header: the lengths are filled in once known
+    dwarf::put(bytes, 0, 4);
+    dwarf::put(bytes, _version, 2);
+    dwarf::put(bytes, 0, 4);
+
+    auto header_start = bytes.size();
+
+    bytes.push_back(1);     // minimum instruction length
+    bytes.push_back(1);     // maximum operations per instruction
+    bytes.push_back(1);     // default is_stmt
+    bytes.push_back(static_cast<std::uint8_t>(_line_base));
+    bytes.push_back(_line_range);
+    bytes.push_back(_opcode_base);
+    bytes.insert(bytes.end(), std::begin(_standard_lengths), std::end(_standard_lengths));
+
+    // no include directories; the names of the files are either absolute, or relative to the compilation directory
+    bytes.push_back(0);
+
+    for (const auto & name : names)
+    {
+        dwarf::string(bytes, name);
+        dwarf::uleb128(bytes, 0);
+        dwarf::uleb128(bytes, 0);
+        dwarf::uleb128(bytes, 0);
+    }
+
+    bytes.push_back(0);
+
+    auto header_length = bytes.size() - header_start;
+
+    for (std::uint8_t i = 0; i < 4; ++i)
+    {
+        bytes[start + 6 + i] = static_cast<std::uint8_t>(header_length >> (8 * i));
+    }
+
+    // a sequence per section
+    for (std::uint32_t section = 0; section < resolved.size(); ++section)
+    {
+        if (resolved[section].empty())
+        {
+            continue;
+        }
+
+        const auto & offsets = rows[section].offsets;
+
+        bytes.push_back(_extended);
+        dwarf::uleb128(bytes, 1 + address_size);
+        bytes.push_back(_set_address);
+        _address(line, section, 0, address_size);
+
+        std::uint64_t address = 0;
+        std::uint64_t file = 1;
+        std::uint64_t current = 1;
+        std::size_t row = 0;
+
+        for (std::size_t i = 0; i < offsets.size(); ++i)
+        {
+            if (i + 1 < offsets.size() && offsets[i + 1] == offsets[i])
+            {
+                continue;
+            }
+
+            auto next = resolved[section][row++];
+
+            // the code of a line often continues through several statements
+            if (row > 1 && next.first == file && next.second == current)
+            {
+                continue;
+            }
+
+            if (next.first != file)
+            {
+                bytes.push_back(_set_file);
+                dwarf::uleb128(bytes, next.first);
+                file = next.first;
+            }
+
+            auto line_delta = static_cast<std::int64_t>(next.second - current);
+            auto address_delta = offsets[i] - address;
+
+            if (line_delta < _line_base || line_delta >= _line_base + _line_range)
+            {
+                bytes.push_back(_advance_line);
+                dwarf::sleb128(bytes, line_delta);
+                line_delta = 0;
+            }
+
+            if ((line_delta - _line_base) + _line_range * address_delta + _opcode_base > 255)
+            {
+                bytes.push_back(_advance_pc);
+                dwarf::uleb128(bytes, address_delta);
+                address_delta = 0;
+            }
+
+            bytes.push_back(static_cast<std::uint8_t>((line_delta - _line_base) + _line_range * address_delta + _opcode_base));
+
+            address = offsets[i];
+            current = next.second;
+            ++ret.rows;
+        }
+
+        bytes.push_back(_advance_pc);
+        dwarf::uleb128(bytes, output.sections()[section].size() - address);
+        bytes.push_back(_extended);
+        dwarf::uleb128(bytes, 1);
+        bytes.push_back(_end_sequence);
+    }
+
+    _close(bytes, start);
+
+    // the compilation unit spans all the sections with code described
+    auto & ranges = output.sections()[ranges_index];
+    auto ranges_start = ranges.size();
+
+    for (std::uint32_t section = 0; section < resolved.size(); ++section)
+    {
+        if (!resolved[section].empty())
+        {
+            _address(ranges, section, 0, address_size);
+            _address(ranges, section, output.sections()[section].size(), address_size);
+        }
+    }
+
+    dwarf::put(ranges.bytes(), 0, 2 * address_size);
+
+    auto & abbrev = output.sections()[abbrev_index];
+    auto abbrev_start = abbrev.size();
+
+    dwarf::uleb128(abbrev.bytes(), 1);
+    dwarf::uleb128(abbrev.bytes(), _compile_unit);
+    abbrev.bytes().push_back(0);
+    abbrev.bytes().insert(abbrev.bytes().end(), std::begin(_attributes), std::end(_attributes));
+    abbrev.bytes().push_back(0);
+
+    auto & info = output.sections()[info_index];
+    auto info_start = info.size();
+    std::string producer = version_string;
+
+    dwarf::put(info.bytes(), 0, 4);
+    dwarf::put(info.bytes(), _version, 2);
+    _address(info, abbrev_index, abbrev_start, 4);
+    info.bytes().push_back(address_size);
+    dwarf::uleb128(info.bytes(), 1);
+    _address(info, line_index, start, 4);
+    dwarf::put(info.bytes(), 0, address_size);
+    _address(info, ranges_index, ranges_start, 4);
+    dwarf::string(info.bytes(), front.input_name());
+    dwarf::string(info.bytes(), boost::filesystem::current_path().string());
+    dwarf::string(info.bytes(), producer.substr(0, producer.find('\n')));
+    dwarf::put(info.bytes(), _assembler_language, 2);
+    _close(info.bytes(), info_start);
+
+    return ret;
+}
@@ -0,0 +1,57 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "../output/module.h"
+#include "../frontend/frontend.h"
+
+namespace reaver
+{
+    namespace assembler
+    {
+        // where the code of the instructions of a section starts, with the locations of the instructions, in order of offsets
+        struct line_rows
+        {
+            std::vector<std::uint64_t> offsets;
+            std::vector<std::uint32_t> locations;
+        };
+
+        struct line_statistics
+        {
+            std::size_t rows = 0;
+            std::size_t files = 0;
+        };
+
+        // describes the source lines of the code in `.debug_line`, as a single compilation unit (in `.debug_info` and
+        // `.debug_abbrev`) covering the sections with rows (listed in `.debug_ranges`)
+        //
+        // rows of the same line are folded, and the line number program is delta encoded with the special opcodes wherever
+        // they fit; the addresses are relocated against the sections of the code, and must be final
+        line_statistics describe_lines(module & output, const std::vector<line_rows> & rows, const frontend & front,
+            bool long_mode);
+    }
+}
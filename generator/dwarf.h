@@ -0,0 +1,80 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace reaver
+{
+    namespace assembler
+    {
+        // the encodings shared by the DWARF based sections, appended to a section's buffer
+        namespace dwarf
+        {
+            // little endian, `size` bytes
+            inline void put(std::vector<std::uint8_t> & bytes, std::uint64_t value, std::uint8_t size)
+            {
+                for (std::uint8_t i = 0; i < size; ++i)
+                {
+                    bytes.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+                }
+            }
+
+            inline void uleb128(std::vector<std::uint8_t> & bytes, std::uint64_t value)
+            {
+                do
+                {
+                    auto byte = static_cast<std::uint8_t>(value & 0x7f);
+                    value >>= 7;
+                    bytes.push_back(value ? byte | 0x80 : byte);
+                } while (value);
+            }
+
+            inline void sleb128(std::vector<std::uint8_t> & bytes, std::int64_t value)
+            {
+                while (true)
+                {
+                    auto byte = static_cast<std::uint8_t>(value & 0x7f);
+                    value >>= 7;
+
+                    if ((value == 0 && !(byte & 0x40)) || (value == -1 && (byte & 0x40)))
+                    {
+                        bytes.push_back(byte);
+                        return;
+                    }
+
+                    bytes.push_back(byte | 0x80);
+                }
+            }
+
+            // null terminated
+            inline void string(std::vector<std::uint8_t> & bytes, const std::string & value)
+            {
+                bytes.insert(bytes.end(), value.begin(), value.end());
+                bytes.push_back(0);
+            }
+        }
+    }
+}
@@ -0,0 +1,269 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include <algorithm>
+
+#include "frame.h"
+#include "dwarf.h"
+
+namespace
+{
+    // call frame instructions, from the DWARF standard
+    enum _instructions : std::uint8_t
+    {
+        _nop = 0x00,
+        _advance_loc1 = 0x02,
+        _advance_loc2 = 0x03,
+        _advance_loc4 = 0x04,
+        _offset_extended_sf = 0x11,
+        _remember_state = 0x0a,
+        _restore_state = 0x0b,
+        _def_cfa = 0x0c,
+        _def_cfa_register = 0x0d,
+        _def_cfa_offset = 0x0e,
+        _advance_loc = 0x40,        // the delta in the low 6 bits
+        _offset = 0x80,             // the register in the low 6 bits
+        _restore = 0xc0             // the register in the low 6 bits
+    };
+
+    // `.eh_frame` flavor of the augmentation: FDEs refer to their code with 32-bit pc-relative pointers
+    constexpr std::uint8_t _pcrel_sdata4 = 0x1b;
+
+    // what the stack looks like right after a call, in DWARF terms
+    struct _abi
+    {
+        std::uint8_t slot;
+        std::uint8_t stack_pointer;
+        std::uint8_t return_address;
+    };
+
+    constexpr _abi _long_mode{ 8, 7, 16 };
+    constexpr _abi _protected_mode{ 4, 4, 8 };
+
+    // DWARF numbers the general purpose registers of x86_64 in their own order; in i386 they follow the encoding
+    std::uint8_t _dwarf(reaver::assembler::register_id reg, bool long_mode)
+    {
+        static const std::uint8_t long_mode_numbers[] = { 0, 2, 1, 3, 7, 6, 4, 5, 8, 9, 10, 11, 12, 13, 14, 15 };
+        return long_mode ? long_mode_numbers[reg.number()] : reg.number();
+    }
+
+    void _advance(std::vector<std::uint8_t> & bytes, std::uint64_t delta)
+    {
+        if (!delta)
+        {
+            return;
+        }
+
+        if (delta < 64)
+        {
+            bytes.push_back(_advance_loc | static_cast<std::uint8_t>(delta));
+        }
+
+        else if (delta <= 0xff)
+        {
+            bytes.push_back(_advance_loc1);
+            reaver::assembler::dwarf::put(bytes, delta, 1);
+        }
+
+        else if (delta <= 0xffff)
+        {
+            bytes.push_back(_advance_loc2);
+            reaver::assembler::dwarf::put(bytes, delta, 2);
+        }
+
+        else
+        {
+            bytes.push_back(_advance_loc4);
+            reaver::assembler::dwarf::put(bytes, delta, 4);
+        }
+    }
+
+    // finishes an entry started at `start` with its length field left zeroed; entries are padded with `DW_CFA_nop` to keep
+    // the next one aligned
+    void _close(std::vector<std::uint8_t> & bytes, std::uint64_t start, std::uint8_t alignment)
+    {
+        bytes.resize(bytes.size() + (alignment - (bytes.size() - start) % alignment) % alignment, _nop);
+
+        auto length = bytes.size() - start - 4;
+
+        for (std::uint8_t i = 0; i < 4; ++i)
+        {
+            bytes[start + i] = static_cast<std::uint8_t>(length >> (8 * i));
+        }
+    }
+}
+
+reaver::assembler::frame_statistics reaver::assembler::build_frames(reaver::assembler::module & output,
+    const std::vector<std::vector<reaver::assembler::frame_directive>> & directives, bool long_mode)
+{
+    using kinds = cfi_directive::kinds;
+
+    frame_statistics ret;
+
+    if (std::all_of(directives.begin(), directives.end(), [](const std::vector<frame_directive> & d){ return d.empty(); }))
+    {
+        return ret;
+    }
+
+    const auto & abi = long_mode ? _long_mode : _protected_mode;
+    auto data_alignment = -static_cast<std::int64_t>(abi.slot);
+
+    auto index = output.section_index(".eh_frame");
+    auto & target = output.sections()[index];
+    auto & bytes = target.bytes();
+
+    bytes.resize(bytes.size() + (abi.slot - bytes.size() % abi.slot) % abi.slot, 0);
+    auto start = bytes.size();
+
+    // the CIE: length, CIE id (0), version, augmentation, code and data alignment factors, return address register, the
+    // augmentation data, and the initial instructions: the cfa is the stack pointer before the call, and the return address
+    // was pushed just below it
+    dwarf::put(bytes, 0, 4);
+    dwarf::put(bytes, 0, 4);
+    bytes.push_back(1);
+    bytes.insert(bytes.end(), { 'z', 'R', 0 });
+    dwarf::uleb128(bytes, 1);
+    dwarf::sleb128(bytes, data_alignment);
+    dwarf::uleb128(bytes, abi.return_address);
+    dwarf::uleb128(bytes, 1);
+    bytes.push_back(_pcrel_sdata4);
+    bytes.push_back(_def_cfa);
+    dwarf::uleb128(bytes, abi.stack_pointer);
+    dwarf::uleb128(bytes, abi.slot);
+    bytes.push_back(_offset | abi.return_address);
+    dwarf::uleb128(bytes, 1);
+    _close(bytes, start, abi.slot);
+
+    auto cie = start;
+
+    for (std::uint32_t section = 0; section < directives.size(); ++section)
+    {
+        std::uint64_t fde = 0;
+        std::uint64_t begin = 0;
+        std::uint64_t location = 0;
+        std::int64_t cfa = 0;
+        std::vector<std::int64_t> remembered;
+
+        for (const auto & d : directives[section])
+        {
+            const auto & directive = d.directive;
+
+            switch (directive.kind)
+            {
+                case kinds::startproc:
+                    fde = bytes.size();
+                    begin = d.offset;
+                    location = d.offset;
+                    cfa = abi.slot;
+                    remembered.clear();
+
+                    // length, offset back to the CIE, the first address (relocated), the size of the code (filled in at
+                    // `cfi_endproc`) and the (empty) augmentation data
+                    dwarf::put(bytes, 0, 4);
+                    dwarf::put(bytes, bytes.size() - cie, 4);
+                    target.fixups().push_back({ bytes.size(), static_cast<std::int64_t>(d.offset), no_symbol, 4,
+                        fixup::kinds::relative, section });
+                    dwarf::put(bytes, 0, 4);
+                    dwarf::put(bytes, 0, 4);
+                    dwarf::uleb128(bytes, 0);
+                    break;
+
+                case kinds::endproc:
+                    for (std::uint8_t i = 0; i < 4; ++i)
+                    {
+                        bytes[fde + 12 + i] = static_cast<std::uint8_t>((d.offset - begin) >> (8 * i));
+                    }
+
+                    _close(bytes, fde, abi.slot);
+                    ++ret.procedures;
+                    break;
+
+                default:
+                    _advance(bytes, d.offset - location);
+                    location = d.offset;
+
+                    switch (directive.kind)
+                    {
+                        case kinds::def_cfa:
+                            cfa = directive.offset;
+                            bytes.push_back(_def_cfa);
+                            dwarf::uleb128(bytes, _dwarf(directive.reg, long_mode));
+                            dwarf::uleb128(bytes, cfa);
+                            break;
+
+                        case kinds::def_cfa_register:
+                            bytes.push_back(_def_cfa_register);
+                            dwarf::uleb128(bytes, _dwarf(directive.reg, long_mode));
+                            break;
+
+                        case kinds::def_cfa_offset:
+                        case kinds::adjust_cfa_offset:
+                            cfa = directive.kind == kinds::def_cfa_offset ? directive.offset : cfa + directive.offset;
+                            bytes.push_back(_def_cfa_offset);
+                            dwarf::uleb128(bytes, cfa);
+                            break;
+
+                        case kinds::offset:
+                        {
+                            auto factored = directive.offset / data_alignment;
+
+                            if (factored >= 0)
+                            {
+                                bytes.push_back(_offset | _dwarf(directive.reg, long_mode));
+                                dwarf::uleb128(bytes, factored);
+                            }
+
+                            else
+                            {
+                                bytes.push_back(_offset_extended_sf);
+                                dwarf::uleb128(bytes, _dwarf(directive.reg, long_mode));
+                                dwarf::sleb128(bytes, factored);
+                            }
+
+                            break;
+                        }
+
+                        case kinds::restore:
+                            bytes.push_back(_restore | _dwarf(directive.reg, long_mode));
+                            break;
+
+                        case kinds::remember_state:
+                            bytes.push_back(_remember_state);
+                            remembered.push_back(cfa);
+                            break;
+
+                        case kinds::restore_state:
+                            bytes.push_back(_restore_state);
+                            cfa = remembered.back();
+                            remembered.pop_back();
+                            break;
+
+                        default:
+                            break;
+                    }
+            }
+        }
+    }
+
+    ret.bytes = bytes.size() - start;
+    return ret;
+}
@@ -0,0 +1,58 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "../output/module.h"
+#include "../parser/ast.h"
+
+namespace reaver
+{
+    namespace assembler
+    {
+        // a call frame directive, at its final offset within its section
+        struct frame_directive
+        {
+            cfi_directive directive;
+            std::uint64_t offset;
+        };
+
+        struct frame_statistics
+        {
+            std::size_t procedures = 0;
+            std::size_t bytes = 0;
+        };
+
+        // appends the unwinding information described by the call frame directives of every section (indexed by section, in
+        // order of their offsets) to `.eh_frame`: a single CIE, shared by all the procedures, since they all start the same
+        // way, right after a call, followed by an FDE per `cfi_startproc` and `cfi_endproc` pair
+        //
+        // the directives must already be checked to be properly paired and nested, and the offsets given to `cfi_offset` to
+        // be multiples of the stack slot size
+        frame_statistics build_frames(module & output, const std::vector<std::vector<frame_directive>> & directives,
+            bool long_mode);
+    }
+}
@@ -23,7 +23,6 @@
  **/
 
 #include "generator.h"
-#include "none/none.h"
 #include "intel/intel.h"
 
 using reaver::style::colors;
@@ -31,14 +30,22 @@ using reaver::style::styles;
 
 using namespace reaver::target;
 
-std::unique_ptr<reaver::assembler::generator> reaver::assembler::create_generator(const reaver::assembler::frontend & front,
-    reaver::error_engine & engine)
+std::unique_ptr<reaver::assembler::module> reaver::assembler::generator::operator()(
+    reaver::assembler::utils::bounded_queue<reaver::assembler::ast> & input) const
 {
-    if (front.preprocess_only())
+    ast whole;
+
+    while (auto fragment = input.pop())
     {
-        return std::make_unique<none_generator>();
+        whole.append(std::move(*fragment));
     }
 
+    return (*this)(whole);
+}
+
+std::unique_ptr<reaver::assembler::generator> reaver::assembler::create_generator(const reaver::assembler::frontend & front,
+    reaver::error_engine & engine)
+{
     if (front.target().arch() >= arch::i386 && front.target().arch() <= arch::x86_64)
     {
         return std::make_unique<intel_generator>(front, engine);
@@ -26,10 +26,11 @@
 #include <map>
 
 #include <reaver/error.h>
-#include <reaver/format/executable.h>
 
 #include "../frontend/frontend.h"
 #include "../parser/ast.h"
+#include "../output/module.h"
+#include "../utils/bounded_queue.h"
 
 namespace reaver
 {
@@ -44,7 +45,13 @@ namespace reaver
 
             virtual ~generator() {}
 
-            virtual std::unique_ptr<format::executable::executable> operator()(const ast &) const = 0;
+            virtual std::unique_ptr<module> operator()(const ast &) const = 0;
+
+            // streaming mode; pops ast fragments until the input is closed
+            //
+            // the default implementation appends all the fragments and falls back to the batch mode, so it holds the whole
+            // tree in memory like the batch mode does; no generator overrides it yet
+            virtual std::unique_ptr<module> operator()(utils::bounded_queue<ast> &) const;
         };
 
         std::unique_ptr<generator> create_generator(const frontend &, error_engine &);
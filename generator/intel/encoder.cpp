@@ -0,0 +1,473 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include "encoder.h"
+
+using namespace reaver::assembler::operand_classes;
+using reaver::assembler::register_id;
+using reaver::assembler::fixup;
+
+namespace
+{
+    constexpr std::uint8_t _invalid = 0xFF;
+
+    // indexed by the register's number; es, cs, ss, ds, fs, gs
+    constexpr std::uint8_t _segment_prefixes[] = { 0x26, 0x2E, 0x36, 0x3E, 0x64, 0x65 };
+
+    // 16 bit addressing; the rm field by base and index register number, with 8 standing for "no register"
+    constexpr std::uint8_t _rm16[9][9] = {
+        { _invalid, _invalid, _invalid, _invalid, _invalid, _invalid, _invalid, _invalid, _invalid },
+        { _invalid, _invalid, _invalid, _invalid, _invalid, _invalid, _invalid, _invalid, _invalid },
+        { _invalid, _invalid, _invalid, _invalid, _invalid, _invalid, _invalid, _invalid, _invalid },
+        // bx
+        { _invalid, _invalid, _invalid, _invalid, _invalid, _invalid, 0, 1, 7 },
+        { _invalid, _invalid, _invalid, _invalid, _invalid, _invalid, _invalid, _invalid, _invalid },
+        // bp
+        { _invalid, _invalid, _invalid, _invalid, _invalid, _invalid, 2, 3, 6 },
+        // si
+        { _invalid, _invalid, _invalid, 0, _invalid, 2, _invalid, _invalid, 4 },
+        // di
+        { _invalid, _invalid, _invalid, 1, _invalid, 3, _invalid, _invalid, 5 },
+        // no base
+        { _invalid, _invalid, _invalid, 7, _invalid, 6, 4, 5, 6 }
+    };
+
+    // SIB scale field by scale
+    constexpr std::uint8_t _scales[] = { _invalid, 0, 1, _invalid, 2, _invalid, _invalid, _invalid, 3 };
+
+    std::uint8_t _immediate_size(std::uint64_t slot)
+    {
+        if (slot & (imm8 | simm8 | rel8))
+        {
+            return 1;
+        }
+
+        if (slot & (imm16 | rel16 | ptr16_16))
+        {
+            return 2;
+        }
+
+        if (slot & (imm32 | simm32 | rel32 | ptr16_32))
+        {
+            return 4;
+        }
+
+        if (slot & imm64)
+        {
+            return 8;
+        }
+
+        return 0;
+    }
+
+    void _append(std::vector<std::uint8_t> & buffer, std::uint64_t value, std::uint8_t size)
+    {
+        for (std::uint8_t i = 0; i < size; ++i)
+        {
+            buffer.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    bool _fits8(std::int64_t value)
+    {
+        return value >= -128 && value <= 127;
+    }
+
+    struct _prefixes
+    {
+        std::uint8_t rex = 0;
+        bool forbid_rex = false;
+        bool address_size = false;
+    };
+
+    void _check(register_id reg, std::uint16_t bits, _prefixes & prefixes)
+    {
+        if (reg.extended() || reg.requires_rex() || (reg.kind() == register_id::general && reg.size() == 8))
+        {
+            if (bits != reaver::assembler::intel::bits64)
+            {
+                throw reaver::assembler::intel::encoding_error{ "register only available in 64-bit mode." };
+            }
+        }
+
+        if (reg.requires_rex())
+        {
+            prefixes.rex |= 0x40;
+        }
+
+        prefixes.forbid_rex = prefixes.forbid_rex || reg.high_byte();
+    }
+
+    struct _address
+    {
+        std::uint8_t modrm = 0;
+        std::uint8_t sib = 0;
+        bool has_sib = false;
+        std::uint8_t displacement_size = 0;
+        bool rip_relative = false;
+    };
+
+    _address _encode_address(const reaver::assembler::operand & op, std::uint16_t bits, _prefixes & prefixes)
+    {
+        using reaver::assembler::intel::encoding_error;
+        using namespace reaver::assembler::intel;
+
+        _address ret;
+
+        auto base = op.base;
+        auto index = op.index;
+        std::uint8_t scale = op.scale ? op.scale : 1;
+
+        if (base && index && base.size() != index.size())
+        {
+            throw encoding_error{ "registers of different sizes used in a single effective address." };
+        }
+
+        std::uint8_t native = bits == bits64 ? 8 : bits == bits32 ? 4 : 2;
+        std::uint8_t size = base ? base.size() : index ? index.size() : native;
+
+        if (base.kind() == register_id::instruction_pointer && bits != bits64)
+        {
+            throw encoding_error{ "rip-relative addressing is only available in 64-bit mode." };
+        }
+
+        if ((size == 8 && bits != bits64) || (size == 2 && bits == bits64))
+        {
+            throw encoding_error{ "invalid effective address for the current mode." };
+        }
+
+        prefixes.address_size = size != native;
+
+        auto & displacement = op.value;
+        bool symbolic = !displacement.constant();
+
+        if (size == 2)
+        {
+            if (scale != 1)
+            {
+                throw encoding_error{ "scaled index registers are not available in 16-bit addressing." };
+            }
+
+            auto rm = _rm16[base ? base.number() : 8][index ? index.number() : 8];
+
+            if (rm == _invalid || base.extended() || index.extended())
+            {
+                throw encoding_error{ "invalid effective address." };
+            }
+
+            if (!base && !index)
+            {
+                ret.modrm = 6;
+                ret.displacement_size = 2;
+                return ret;
+            }
+
+            ret.modrm = rm;
+
+            // [bp] has no encoding without a displacement
+            if (symbolic || displacement.value || rm == 6)
+            {
+                ret.displacement_size = !symbolic && _fits8(displacement.value) ? 1 : 2;
+                ret.modrm |= (ret.displacement_size == 1 ? 1 : 2) << 6;
+            }
+
+            return ret;
+        }
+
+        if (!symbolic && (displacement.value < -0x80000000ll || displacement.value > 0xFFFFFFFFll))
+        {
+            throw encoding_error{ "displacement out of range." };
+        }
+
+        // esp can't be an index, but an unscaled one can be swapped with the base
+        if (index && index.number() == 4)
+        {
+            if (scale != 1 || (base && base.number() == 4))
+            {
+                throw encoding_error{ "invalid effective address; the stack pointer cannot be an index register." };
+            }
+
+            std::swap(base, index);
+        }
+
+        if (base.kind() == register_id::instruction_pointer || (!base && !index && op.relative && bits == bits64))
+        {
+            if (index)
+            {
+                throw encoding_error{ "rip-relative addresses cannot have an index register." };
+            }
+
+            ret.modrm = 5;
+            ret.displacement_size = 4;
+            ret.rip_relative = base.kind() != register_id::instruction_pointer;
+            return ret;
+        }
+
+        if (!base && !index)
+        {
+            if (bits == bits64)
+            {
+                // mod 00 rm 101 means rip-relative in 64-bit mode, so absolute addresses go through a SIB without base or
+                // index
+                ret.modrm = 4;
+                ret.sib = 0x25;
+                ret.has_sib = true;
+            }
+
+            else
+            {
+                ret.modrm = 5;
+            }
+
+            ret.displacement_size = 4;
+            return ret;
+        }
+
+        if (!base)
+        {
+            ret.modrm = 4;
+            ret.sib = (_scales[scale] << 6) | ((index.number() & 7) << 3) | 5;
+            ret.has_sib = true;
+            ret.displacement_size = 4;
+            prefixes.rex |= index.extended() ? 0x42 : 0;
+            return ret;
+        }
+
+        if (symbolic || displacement.value || (base.number() & 7) == 5)
+        {
+            ret.displacement_size = !symbolic && _fits8(displacement.value) ? 1 : 4;
+            ret.modrm |= (ret.displacement_size == 1 ? 1 : 2) << 6;
+        }
+
+        if (index || (base.number() & 7) == 4)
+        {
+            ret.modrm |= 4;
+            ret.sib = (_scales[scale] << 6) | ((index ? index.number() & 7 : 4) << 3) | (base.number() & 7);
+            ret.has_sib = true;
+            prefixes.rex |= index.extended() ? 0x42 : 0;
+        }
+
+        else
+        {
+            ret.modrm |= base.number() & 7;
+        }
+
+        prefixes.rex |= base.extended() ? 0x41 : 0;
+
+        return ret;
+    }
+}
+
+void reaver::assembler::intel::encode(const reaver::assembler::instruction & i, const reaver::assembler::intel::opcode & form,
+    std::uint16_t bits, reaver::assembler::section & output)
+{
+    auto & buffer = output.bytes();
+    auto & fixups = output.fixups();
+    auto first_fixup = fixups.size();
+
+    // zeroes a field and records a fixup for it, unless it's a constant that is known already
+    auto field = [&](const expression & value, std::uint8_t size, fixup::kinds kind, bool force = false)
+    {
+        if (!value.constant() || force)
+        {
+            fixups.push_back({ buffer.size(), value.value, value.symbol, size, kind });
+            _append(buffer, 0, size);
+            return;
+        }
+
+        _append(buffer, value.value, size);
+    };
+
+    _prefixes prefixes;
+    prefixes.rex = (form.modes & rexw) ? 0x48 : (form.modes & rex) ? 0x40 : 0;
+    prefixes.rex |= (form.modes & rexr) ? 0x44 : 0;
+
+    bool register_in_opcode = form.modes & (rb | rw | rd | ro);
+    bool has_modrm = form.rm_index != -1 || form.reg_index != -1;
+
+    std::uint8_t modrm = 0;
+    _address address;
+    const operand * memory = nullptr;
+
+    for (std::uint8_t c = 0; c < i.operand_count; ++c)
+    {
+        if (i.operands[c].kind == operand::kinds::reg)
+        {
+            _check(i.operands[c].reg, bits, prefixes);
+        }
+
+        else if (i.operands[c].kind == operand::kinds::memory)
+        {
+            for (auto reg : { i.operands[c].base, i.operands[c].index })
+            {
+                if (reg && reg.kind() == register_id::general)
+                {
+                    _check(reg, bits, prefixes);
+                }
+            }
+
+            memory = &i.operands[c];
+        }
+    }
+
+    if (form.reg_index != -1)
+    {
+        if (form.special_reg)
+        {
+            modrm |= form.reg_index << 3;
+        }
+
+        else
+        {
+            auto reg = i.operands[form.reg_index].reg;
+            modrm |= (reg.number() & 7) << 3;
+            prefixes.rex |= reg.extended() ? 0x44 : 0;
+        }
+    }
+
+    if (form.rm_index != -1)
+    {
+        const auto & op = i.operands[form.rm_index];
+
+        if (op.kind == operand::kinds::reg)
+        {
+            modrm |= 0xC0 | (op.reg.number() & 7);
+            prefixes.rex |= op.reg.extended() ? 0x41 : 0;
+        }
+
+        else
+        {
+            address = _encode_address(op, bits, prefixes);
+            modrm |= address.modrm;
+        }
+    }
+
+    if (register_in_opcode)
+    {
+        prefixes.rex |= i.operands[0].reg.extended() ? 0x41 : 0;
+    }
+
+    if (prefixes.rex && prefixes.forbid_rex)
+    {
+        throw encoding_error{ "high byte registers cannot be encoded in an instruction requiring a REX prefix." };
+    }
+
+    if (memory && memory->segment)
+    {
+        buffer.push_back(_segment_prefixes[memory->segment.number()]);
+    }
+
+    if (prefixes.address_size)
+    {
+        buffer.push_back(0x67);
+    }
+
+    if (((form.modes & mode16) && bits != bits16) || ((form.modes & mode32) && bits == bits16))
+    {
+        buffer.push_back(0x66);
+    }
+
+    if (prefixes.rex)
+    {
+        buffer.push_back(prefixes.rex);
+    }
+
+    if (register_in_opcode)
+    {
+        buffer.push_back(form.code[0] + (i.operands[0].reg.number() & 7));
+    }
+
+    else
+    {
+        buffer.insert(buffer.end(), form.code, form.code + form.code_size);
+    }
+
+    if (has_modrm)
+    {
+        buffer.push_back(modrm);
+
+        if (address.has_sib)
+        {
+            buffer.push_back(address.sib);
+        }
+
+        if (address.displacement_size)
+        {
+            // `[rip + 16]` is a plain displacement, while `[rel 16]` refers to the absolute address 16
+            auto kind = address.rip_relative || memory->base.kind() == register_id::instruction_pointer ? fixup::kinds::relative
+                : bits == bits64 && address.displacement_size == 4 ? fixup::kinds::absolute_signed : fixup::kinds::absolute;
+
+            if (memory->got)
+            {
+                if (!address.rip_relative)
+                {
+                    throw encoding_error{ "`wrt ..got` is only supported in 64 bit code." };
+                }
+
+                kind = prefixes.rex ? fixup::kinds::got_rex : fixup::kinds::got;
+            }
+
+            field(memory->value, address.displacement_size, kind, address.rip_relative);
+        }
+    }
+
+    for (std::int8_t c = register_in_opcode; c < i.operand_count; ++c)
+    {
+        const auto & op = i.operands[c];
+
+        if (c == form.rm_index || (c == form.reg_index && !form.special_reg) || op.kind == operand::kinds::reg)
+        {
+            continue;
+        }
+
+        auto size = _immediate_size(form.operands[c]);
+
+        if (!size)
+        {
+            throw encoding_error{ "invalid operand; consider this an internal error." };
+        }
+
+        if (form.operands[c] & (rel8 | rel16 | rel32))
+        {
+            field(op.value, size, fixup::kinds::branch, true);
+        }
+
+        else
+        {
+            field(op.value, size, form.operands[c] & (simm8 | simm32) ? fixup::kinds::absolute_signed : fixup::kinds::absolute);
+        }
+
+        if (op.kind == operand::kinds::far_pointer)
+        {
+            _append(buffer, op.far_segment, 2);
+        }
+    }
+
+    // relative fields are relative to the end of the instruction, not to the field itself
+    for (auto it = fixups.begin() + first_fixup; it != fixups.end(); ++it)
+    {
+        if (it->relative())
+        {
+            it->addend -= buffer.size() - it->offset;
+        }
+    }
+}
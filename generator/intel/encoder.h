@@ -22,22 +22,28 @@
 
 #pragma once
 
-#include "../generator.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../../parser/ast.h"
+#include "../../output/section.h"
+#include "opcodes.h"
 
 namespace reaver
 {
     namespace assembler
     {
-        class none_generator : public generator
+        namespace intel
         {
-        public:
-            none_generator()
+            struct encoding_error
             {
-            }
-
-            virtual ~none_generator() {}
+                std::string message;
+            };
 
-            virtual std::unique_ptr<format::executable::executable> operator()(const ast &) const override;
-        };
+            // appends the encoding of an instruction, using the form selected for it, to a section, together with fixups
+            // for every field referring to a symbol; `bits` is one of `bits16`, `bits32` and `bits64`
+            void encode(const instruction & i, const opcode & form, std::uint16_t bits, section & output);
+        }
     }
 }
@@ -20,12 +20,1069 @@
  *
  **/
 
+#include <algorithm>
+#include <string>
+#include <utility>
+
 #include <reaver/exception.h>
 
 #include "../intel/intel.h"
+#include "opcodes.h"
+#include "encoder.h"
+#include "../relaxation.h"
+#include "../merge.h"
+#include "../frame.h"
+#include "../../utils/thread_pool.h"
+#include "../../preprocessor/source_buffer.h"
+#include "../../parser/symbol_table.h"
+
+using namespace reaver::assembler::operand_classes;
+
+namespace
+{
+    enum class _selection_error
+    {
+        none,
+        no_match,
+        ambiguous_size
+    };
+
+    constexpr std::uint64_t _sized_rm = rm8 | rm16 | rm32 | rm64;
+
+    // whether the form needs an operand size override (prefix or REX.W) in the given mode
+    bool _overrides_size(const reaver::assembler::intel::opcode & form, std::uint16_t bits)
+    {
+        using namespace reaver::assembler::intel;
+        return (form.modes & rexw) || ((form.modes & mode16) && bits != bits16) || ((form.modes & mode32) && bits == bits16);
+    }
+
+    // the parser has already reduced every operand to the set of classes it satisfies, so a form matches when each of its
+    // slots intersects the corresponding operand's set; absent operands only satisfy `none`, which is also what unused slots
+    // of a form hold
+    const reaver::assembler::intel::opcode * _select(const reaver::assembler::instruction & i, std::uint16_t bits,
+        _selection_error & error)
+    {
+        const auto & ops = i.operands;
+
+        // an unsized memory operand with nothing else to fix the size is only fine when the mode's native size is the
+        // only choice (`jmp [rax]`, `push [ebx]`); everything else needs an explicit size
+        std::int8_t unsized = -1;
+        bool has_register = false;
+
+        for (std::uint8_t c = 0; c < i.operand_count; ++c)
+        {
+            if (ops[c].kind == reaver::assembler::operand::kinds::memory && !ops[c].size)
+            {
+                unsized = c;
+            }
+
+            has_register = has_register || ops[c].kind == reaver::assembler::operand::kinds::reg;
+        }
+
+        // candidates that don't need an operand size override are preferred; within either group all candidates must agree
+        // on the size of the memory operand
+        const reaver::assembler::intel::opcode * candidates[2] = {};
+        bool ambiguous[2] = {};
+        const reaver::assembler::intel::opcode * fallback = nullptr;
+
+        for (const auto & form : *i.mnemonic)
+        {
+            if (!(form.modes & bits) || !(form.operands[0] & ops[0].classes) || !(form.operands[1] & ops[1].classes)
+                || !(form.operands[2] & ops[2].classes))
+            {
+                continue;
+            }
+
+            if (unsized == -1 || has_register || !(form.operands[unsized] & _sized_rm))
+            {
+                // an immediate can fit several forms (`push 1000` matches both imm16 and imm32); take the one native to
+                // the mode if there's one
+                if (!_overrides_size(form, bits) || (form.modes & reaver::assembler::intel::rexw))
+                {
+                    return &form;
+                }
+
+                fallback = fallback ? fallback : &form;
+                continue;
+            }
+
+            auto group = _overrides_size(form, bits);
+
+            if (!candidates[group])
+            {
+                candidates[group] = &form;
+            }
+
+            else if (candidates[group]->operands[unsized] != form.operands[unsized])
+            {
+                ambiguous[group] = true;
+            }
+        }
+
+        if (fallback)
+        {
+            return fallback;
+        }
+
+        for (auto group : { 0, 1 })
+        {
+            if (candidates[group])
+            {
+                if (ambiguous[group])
+                {
+                    error = _selection_error::ambiguous_size;
+                    return nullptr;
+                }
+
+                return candidates[group];
+            }
+        }
+
+        error = _selection_error::no_match;
+        return nullptr;
+    }
+
+    // whether the data gives any bytes a value other than 0
+    bool _initializes(const reaver::assembler::data & d)
+    {
+        return std::any_of(d.items.begin(), d.items.end(), [](const reaver::assembler::data_item & item)
+        {
+            return !item.value.constant() || item.value.value || std::any_of(item.string.begin(), item.string.end(),
+                [](char c){ return c; });
+        });
+    }
+}
+
+void reaver::assembler::intel_generator::_error(std::uint32_t location, std::string message) const
+{
+    auto & sources = _front.sources();
+
+    _engine.push({
+        sources.include_chain(location)->exception(sources.column(location)),
+        exception(logger::error) << message
+    });
+}
+
+// a contiguous run of statements of a single section, encoded independently of all the others into a buffer of its own;
+// symbol values aren't needed for encoding, so labels are only recorded with their offsets within the chunk
+struct reaver::assembler::intel_generator::_chunk
+{
+    _chunk(std::size_t first, std::uint32_t section, std::uint16_t bits, boost::string_ref name) : first{ first }, last{ first },
+        section{ section }, bits{ bits }, output{ name }
+    {
+    }
+
+    std::size_t first;
+    std::size_t last;
+    std::uint32_t section;
+    std::uint16_t bits;
+
+    reaver::assembler::section output;
+    std::vector<relaxable_branch> branches;
+    // statement index, offset
+    std::vector<std::pair<std::size_t, std::uint64_t>> labels;
+    // offsets of the call frame directives, in order
+    std::vector<std::uint64_t> frames;
+    // only with debugging information
+    line_rows lines;
+    std::vector<std::pair<std::uint32_t, std::string>> errors;
+};
+
+// the procedure (`cfi_startproc` to `cfi_endproc`) call frame directives are being checked in
+struct reaver::assembler::intel_generator::_procedure
+{
+    bool open = false;
+    std::uint32_t section = 0;
+    std::uint32_t location = 0;
+    std::uint8_t slot = 0;
+    std::int64_t cfa = 0;
+    std::vector<std::int64_t> remembered;
+};
+
+std::unique_ptr<reaver::assembler::module> reaver::assembler::intel_generator::operator()(const ast & tree) const
+{
+    std::uint16_t bits = _front.target().arch() == target::arch::x86_64 ? intel::bits64 : intel::bits32;
+
+    auto output = std::make_unique<module>();
+    auto current = output->section_index(".text");
+
+    // the whole tree is here, so the parser is done adding symbols
+    output->symbols().resize(_front.symbols().size());
+
+    // directives are cheap, so they are dealt with while the tree is split into chunks
+    const auto & statements = tree.statements();
+    std::vector<_chunk> chunks;
+    bool origin_set = false;
+
+    // with function sections, a global label in `.text` moves itself and everything after it to a section of its own, and
+    // selecting `.text` again goes back to that section, so data put elsewhere in the middle of a function doesn't cut it
+    // in two; a label can be declared global after it's defined, so all the globals need to be known up front
+    auto text = current;
+    auto function_section = text;
+    auto in_text = true;
+    auto split = _front.function_sections() && _front.format() != "binary";
+
+    for (std::size_t i = 0; split && i < statements.size(); ++i)
+    {
+        if (auto directive = boost::get<global_directive>(&statements[i].value))
+        {
+            output->symbols()[directive->symbol].binding = symbol::bindings::global;
+        }
+    }
+
+    // call frame directives are checked in order here, and go into chunks like labels to get their offsets; flat binaries
+    // have nowhere to put the frames, so there they are ignored
+    _procedure procedure;
+    procedure.slot = _front.target().arch() == target::arch::x86_64 ? 8 : 4;
+    std::vector<std::vector<std::size_t>> frame_statements;
+    auto frames_wanted = _front.format() != "binary";
+
+    // sizes can refer to labels defined later, and depend on where relaxation puts them
+    std::vector<std::size_t> size_statements;
+
+    // globals without a visibility of their own get the default one once they are all known
+    std::vector<bool> visible(output->symbols().size());
+
+    for (std::size_t i = 0; i < statements.size(); ++i)
+    {
+        const auto & statement = statements[i];
+
+        if (auto directive = boost::get<bits_directive>(&statement.value))
+        {
+            bits = directive->bits == 16 ? intel::bits16 : directive->bits == 32 ? intel::bits32 : intel::bits64;
+        }
+
+        else if (auto directive = boost::get<section_directive>(&statement.value))
+        {
+            current = output->section_index(directive->name);
+            in_text = current == text;
+            auto & section = output->sections()[current];
+
+            if ((directive->entry_size && section.entry_size() && (directive->entry_size != section.entry_size()
+                || directive->strings != section.strings())) || ((directive->nobits || section.uninitialized())
+                && (directive->entry_size || section.entry_size())))
+            {
+                _error(statement.location, "conflicting attributes given for section `" + directive->name.to_string() + "`.");
+            }
+
+            else if (directive->entry_size)
+            {
+                section.merge(directive->entry_size, directive->strings);
+            }
+
+            else if (directive->nobits)
+            {
+                section.uninitialized(true);
+            }
+
+            if (split && in_text)
+            {
+                current = function_section;
+            }
+        }
+
+        else if (auto directive = boost::get<global_directive>(&statement.value))
+        {
+            auto & symbol = output->symbols()[directive->symbol];
+            symbol.binding = symbol::bindings::global;
+
+            if (directive->type != symbol_types::none && symbol.type != symbol_types::none && directive->type != symbol.type)
+            {
+                _error(statement.location, "conflicting types given for `" + _front.symbols().name(directive->symbol).to_string()
+                    + "`.");
+            }
+
+            else if (directive->type != symbol_types::none)
+            {
+                symbol.type = directive->type;
+            }
+
+            if (directive->visible && visible[directive->symbol] && directive->visibility != symbol.visibility)
+            {
+                _error(statement.location, "conflicting visibilities given for `"
+                    + _front.symbols().name(directive->symbol).to_string() + "`.");
+            }
+
+            else if (directive->visible)
+            {
+                symbol.visibility = directive->visibility;
+                visible[directive->symbol] = true;
+            }
+        }
 
-std::unique_ptr<reaver::format::executable::executable> reaver::assembler::intel_generator::operator()(const ast &) const
+        else if (boost::get<size_directive>(&statement.value))
+        {
+            size_statements.push_back(i);
+        }
+
+        else if (auto directive = boost::get<extern_directive>(&statement.value))
+        {
+            output->symbols()[directive->symbol].binding = symbol::bindings::external;
+        }
+
+        else if (auto directive = boost::get<org_directive>(&statement.value))
+        {
+            if (_front.format() != "binary")
+            {
+                _error(statement.location, "`org` is only supported in flat binary output.");
+            }
+
+            else if (origin_set)
+            {
+                _error(statement.location, "`org` given more than once.");
+            }
+
+            output->origin(directive->address);
+            origin_set = true;
+        }
+
+        else
+        {
+            if (boost::get<cfi_directive>(&statement.value))
+            {
+                if (!frames_wanted)
+                {
+                    continue;
+                }
+
+                _frame(statement, current, *output, procedure);
+                frame_statements.resize(output->sections().size());
+                frame_statements[current].push_back(i);
+            }
+
+            auto l = boost::get<label>(&statement.value);
+
+            if (split && in_text && l && output->symbols()[l->symbol].binding == symbol::bindings::global)
+            {
+                current = output->section_index(_front.sources().store(".text." + _front.symbols().name(l->symbol).to_string()));
+                function_section = current;
+            }
+
+            if (chunks.empty() || chunks.back().section != current || chunks.back().last - chunks.back().first >= _chunk_size
+                || chunks.back().last != i)
+            {
+                chunks.emplace_back(i, current, bits, output->sections()[current].name());
+            }
+
+            chunks.back().last = i + 1;
+        }
+    }
+
+    if (procedure.open)
+    {
+        _error(procedure.location, "`cfi_startproc` without a matching `cfi_endproc`.");
+    }
+
+    for (std::uint32_t i = 0; i < output->symbols().size(); ++i)
+    {
+        if (output->symbols()[i].binding == symbol::bindings::global && !visible[i])
+        {
+            output->symbols()[i].visibility = _front.default_visibility();
+        }
+    }
+
+    // `nobits` may be given after a section has already been used
+    for (auto & chunk : chunks)
+    {
+        chunk.output.uninitialized(output->sections()[chunk.section].uninitialized());
+    }
+
+    utils::thread_pool pool{ std::min<std::size_t>(_front.jobs(), chunks.size()) };
+    pool.run(chunks.size(), [&](std::size_t i){ _encode(tree, chunks[i]); });
+
+    std::vector<std::vector<std::uint64_t>> frames;
+    std::vector<line_rows> lines;
+    auto branches = _stitch(tree, chunks, *output, frames, lines);
+
+    if (!_engine)
+    {
+        throw std::move(_engine);
+    }
+
+    // undefined symbols are reported at their first reference; finding it is only worth it when there are some
+    std::vector<std::uint32_t> undefined;
+
+    for (std::uint32_t i = 0; i < output->symbols().size(); ++i)
+    {
+        const auto & symbol = output->symbols()[i];
+
+        if ((symbol.section == undefined_section) != (symbol.binding == symbol::bindings::external))
+        {
+            undefined.push_back(i);
+        }
+    }
+
+    if (!undefined.empty())
+    {
+        _report_undefined(tree, *output, undefined);
+        throw std::move(_engine);
+    }
+
+    // with function sections, there can be as many sections as there are symbols, so the passes working on a section at a
+    // time (relaxation and merging) get the symbols defined in it from here, instead of looking through all of them
+    std::vector<std::vector<std::uint32_t>> defined(output->sections().size());
+
+    for (std::uint32_t i = 0; i < output->symbols().size(); ++i)
+    {
+        if (output->symbols()[i].section < defined.size())
+        {
+            defined[output->symbols()[i].section].push_back(i);
+        }
+    }
+
+    for (std::uint32_t section = 0; section < branches.size(); ++section)
+    {
+        auto statistics = relax(*output, section, defined[section], branches[section], { frames[section],
+            lines[section].offsets });
+
+        if (_front.statistics() && statistics.branches)
+        {
+            _engine.push(exception(logger::note) << "relaxation of `" << output->sections()[section].name().to_string() << "`: "
+                << statistics.branches << " branches, " << statistics.grown << " made long, " << statistics.passes
+                << " passes.");
+        }
+    }
+
+    // mergeable sections hold no code, so folding their entries moves neither frames nor line rows; it does move symbols,
+    // so it's done before their sizes are taken
+    for (std::uint32_t section = 0; section < output->sections().size(); ++section)
+    {
+        _merge(*output, section, defined[section]);
+    }
+
+    _sizes(tree, *output, size_statements);
+
+    // the frames are described last, once the code doesn't move anymore
+    std::vector<std::vector<frame_directive>> directives(frame_statements.size());
+
+    for (std::uint32_t section = 0; section < frame_statements.size(); ++section)
+    {
+        for (std::size_t i = 0; i < frame_statements[section].size(); ++i)
+        {
+            directives[section].push_back({ boost::get<cfi_directive>(statements[frame_statements[section][i]].value),
+                frames[section][i] });
+        }
+    }
+
+    auto frame_statistics = build_frames(*output, directives, procedure.slot == 8);
+
+    if (_front.statistics() && frame_statistics.procedures)
+    {
+        _engine.push(exception(logger::note) << "call frames: " << frame_statistics.procedures << " procedures, "
+            << frame_statistics.bytes << " bytes of `.eh_frame`.");
+    }
+
+    if (_front.debug_info() && _front.format() != "binary")
+    {
+        auto line_statistics = describe_lines(*output, lines, _front, procedure.slot == 8);
+
+        if (_front.statistics() && line_statistics.rows)
+        {
+            _engine.push(exception(logger::note) << "line information: " << line_statistics.rows << " rows, "
+                << line_statistics.files << " files.");
+        }
+    }
+
+    _resolve(*output);
+
+    if (!_engine)
+    {
+        throw std::move(_engine);
+    }
+
+    return output;
+}
+
+void reaver::assembler::intel_generator::_frame(const reaver::assembler::statement & statement, std::uint32_t section,
+    const reaver::assembler::module & output, reaver::assembler::intel_generator::_procedure & procedure) const
 {
-    _engine.push(exception(logger::crash) << "not implemented yet: " << __PRETTY_FUNCTION__);
-    throw std::move(_engine);
+    using kinds = cfi_directive::kinds;
+
+    const auto & directive = boost::get<cfi_directive>(statement.value);
+
+    if (directive.kind == kinds::startproc)
+    {
+        if (procedure.open)
+        {
+            _error(statement.location, "`cfi_startproc` inside of another procedure.");
+            return;
+        }
+
+        procedure.open = true;
+        procedure.section = section;
+        procedure.location = statement.location;
+        procedure.cfa = procedure.slot;
+        procedure.remembered.clear();
+        return;
+    }
+
+    if (!procedure.open)
+    {
+        _error(statement.location, "call frame directive outside of a procedure; `cfi_startproc` expected first.");
+        return;
+    }
+
+    if (section != procedure.section)
+    {
+        _error(statement.location, "procedure started in section `" + output.sections()[procedure.section].name().to_string()
+            + "` continued in `" + output.sections()[section].name().to_string() + "`.");
+        return;
+    }
+
+    if (directive.reg && (directive.reg.kind() != register_id::general || directive.reg.size() != procedure.slot))
+    {
+        _error(statement.location, "call frame directives only accept " + std::to_string(procedure.slot * 8) + "-bit general "
+            "purpose registers.");
+        return;
+    }
+
+    switch (directive.kind)
+    {
+        case kinds::endproc:
+            procedure.open = false;
+            break;
+
+        case kinds::def_cfa:
+        case kinds::def_cfa_offset:
+        case kinds::adjust_cfa_offset:
+            procedure.cfa = directive.kind == kinds::adjust_cfa_offset ? procedure.cfa + directive.offset : directive.offset;
+
+            if (procedure.cfa < 0)
+            {
+                _error(statement.location, "cfa offset can't be negative.");
+            }
+
+            break;
+
+        case kinds::offset:
+            if (directive.offset % procedure.slot)
+            {
+                _error(statement.location, "offset given to `cfi_offset` must be a multiple of " + std::to_string(procedure.slot)
+                    + ".");
+            }
+
+            break;
+
+        case kinds::remember_state:
+            procedure.remembered.push_back(procedure.cfa);
+            break;
+
+        case kinds::restore_state:
+            if (procedure.remembered.empty())
+            {
+                _error(statement.location, "`cfi_restore_state` without a matching `cfi_remember_state`.");
+                break;
+            }
+
+            procedure.cfa = procedure.remembered.back();
+            procedure.remembered.pop_back();
+            break;
+
+        default:
+            break;
+    }
+}
+
+void reaver::assembler::intel_generator::_encode(const reaver::assembler::ast & tree,
+    reaver::assembler::intel_generator::_chunk & chunk) const
+{
+    // branches to symbols start out short and are relaxed once all the symbols are known
+    auto optimize = _front.optimization_level() > 0;
+    auto debug = _front.debug_info();
+
+    for (auto index = chunk.first; index < chunk.last; ++index)
+    {
+        const auto & statement = tree.statements()[index];
+
+        if (debug && boost::get<instruction>(&statement.value))
+        {
+            chunk.lines.offsets.push_back(chunk.output.size());
+            chunk.lines.locations.push_back(statement.location);
+        }
+
+        if (boost::get<instruction>(&statement.value) && chunk.output.uninitialized())
+        {
+            chunk.errors.emplace_back(statement.location, "instruction in section `" + chunk.output.name().to_string()
+                + "`, which has no contents.");
+        }
+
+        else if (auto i = boost::get<instruction>(&statement.value))
+        {
+            auto error = _selection_error::none;
+
+            auto form = _select(*i, chunk.bits, error);
+            auto short_form = _short_form(*i, chunk.bits);
+
+            // branches like `jecxz` only have a short form
+            if (!form && short_form)
+            {
+                form = short_form;
+                short_form = nullptr;
+            }
+
+            if (!form)
+            {
+                chunk.errors.emplace_back(statement.location, error == _selection_error::ambiguous_size
+                    ? "operation size not specified." : "invalid combination of opcode and operands.");
+                continue;
+            }
+
+            try
+            {
+                if (short_form && optimize)
+                {
+                    _branch(*i, *form, *short_form, chunk.bits, chunk.output, chunk.branches);
+                }
+
+                else
+                {
+                    intel::encode(*i, *form, chunk.bits, chunk.output);
+                }
+            }
+
+            catch (intel::encoding_error & e)
+            {
+                chunk.errors.emplace_back(statement.location, std::move(e.message));
+            }
+        }
+
+        else if (auto d = boost::get<data>(&statement.value))
+        {
+            if (chunk.output.uninitialized() && _initializes(*d))
+            {
+                chunk.errors.emplace_back(statement.location, "initialized data in section `" + chunk.output.name().to_string()
+                    + "`, which has no contents; only zeros can be put there, or space reserved with `resb` and the like.");
+                continue;
+            }
+
+            _data(*d, chunk.output);
+        }
+
+        else if (auto r = boost::get<reservation>(&statement.value))
+        {
+            chunk.output.extend(r->size * r->count);
+        }
+
+        else if (boost::get<label>(&statement.value))
+        {
+            chunk.labels.emplace_back(index, chunk.output.size());
+        }
+
+        else if (boost::get<cfi_directive>(&statement.value))
+        {
+            chunk.frames.push_back(chunk.output.size());
+        }
+    }
+}
+
+// chunks are put together in order, so the result doesn't depend on how (or whether) they were spread across threads
+std::vector<std::vector<reaver::assembler::relaxable_branch>> reaver::assembler::intel_generator::_stitch(
+    const reaver::assembler::ast & tree, std::vector<reaver::assembler::intel_generator::_chunk> & chunks,
+    reaver::assembler::module & output, std::vector<std::vector<std::uint64_t>> & frames,
+    std::vector<reaver::assembler::line_rows> & lines) const
+{
+    std::vector<std::vector<relaxable_branch>> ret(output.sections().size());
+    frames.resize(output.sections().size());
+    lines.resize(output.sections().size());
+    std::vector<std::uint64_t> sizes(output.sections().size());
+
+    for (const auto & chunk : chunks)
+    {
+        sizes[chunk.section] += chunk.output.bytes().size();
+    }
+
+    for (std::uint32_t i = 0; i < sizes.size(); ++i)
+    {
+        output.sections()[i].bytes().reserve(sizes[i]);
+    }
+
+    for (auto & chunk : chunks)
+    {
+        auto & target = output.sections()[chunk.section];
+        auto base = target.size();
+
+        if (target.uninitialized())
+        {
+            target.extend(chunk.output.size());
+        }
+
+        else
+        {
+            target.bytes().insert(target.bytes().end(), chunk.output.bytes().begin(), chunk.output.bytes().end());
+        }
+
+        for (auto fixup : chunk.output.fixups())
+        {
+            fixup.offset += base;
+            target.fixups().push_back(fixup);
+        }
+
+        for (auto branch : chunk.branches)
+        {
+            branch.offset += base;
+            ret[chunk.section].push_back(branch);
+        }
+
+        for (auto offset : chunk.frames)
+        {
+            frames[chunk.section].push_back(base + offset);
+        }
+
+        for (auto offset : chunk.lines.offsets)
+        {
+            lines[chunk.section].offsets.push_back(base + offset);
+        }
+
+        auto & locations = lines[chunk.section].locations;
+        locations.insert(locations.end(), chunk.lines.locations.begin(), chunk.lines.locations.end());
+
+        for (const auto & label : chunk.labels)
+        {
+            const auto & statement = tree.statements()[label.first];
+            auto index = boost::get<reaver::assembler::label>(statement.value).symbol;
+            auto & symbol = output.symbols()[index];
+
+            if (symbol.section != undefined_section)
+            {
+                _error(statement.location, "symbol `" + _front.symbols().name(index).to_string() + "` redefined.");
+                continue;
+            }
+
+            symbol.section = chunk.section;
+            symbol.value = base + label.second;
+        }
+
+        for (auto & error : chunk.errors)
+        {
+            _error(error.first, std::move(error.second));
+        }
+    }
+
+    return ret;
+}
+
+// explicit sizes go first; symbols with a type but no size span up to the next global label of their section, or up to
+// its end
+void reaver::assembler::intel_generator::_sizes(const reaver::assembler::ast & tree, reaver::assembler::module & output,
+    const std::vector<std::size_t> & statements) const
+{
+    auto & symbols = output.symbols();
+    std::vector<bool> sized(symbols.size());
+
+    for (auto index : statements)
+    {
+        const auto & statement = tree.statements()[index];
+        const auto & directive = boost::get<size_directive>(statement.value);
+        auto & symbol = symbols[directive.symbol];
+        auto name = _front.symbols().name(directive.symbol).to_string();
+        auto size = directive.size.value;
+
+        if (symbol.section == undefined_section)
+        {
+            _error(statement.location, "size given for `" + name + "`, which is external.");
+            continue;
+        }
+
+        if (!directive.size.constant())
+        {
+            const auto & end = symbols[directive.size.symbol];
+
+            if (end.section != symbol.section)
+            {
+                _error(statement.location, "end of `" + name + "` given in another section.");
+                continue;
+            }
+
+            size += static_cast<std::int64_t>(end.value - symbol.value);
+        }
+
+        if (size < 0)
+        {
+            _error(statement.location, "negative size given for `" + name + "`.");
+            continue;
+        }
+
+        symbol.size = size;
+        sized[directive.symbol] = true;
+    }
+
+    std::vector<std::uint32_t> order;
+
+    for (std::uint32_t i = 0; i < symbols.size(); ++i)
+    {
+        if (symbols[i].section != undefined_section)
+        {
+            order.push_back(i);
+        }
+    }
+
+    std::sort(order.begin(), order.end(), [&](std::uint32_t lhs, std::uint32_t rhs)
+    {
+        return std::make_pair(symbols[lhs].section, symbols[lhs].value) < std::make_pair(symbols[rhs].section, symbols[rhs].value);
+    });
+
+    // walking backwards, one group of symbols sharing an address at a time, `end` is where the last global label seen is
+    std::uint32_t section = undefined_section;
+    std::uint64_t end = 0;
+
+    for (auto last = order.size(); last; )
+    {
+        const auto & back = symbols[order[last - 1]];
+
+        if (back.section != section)
+        {
+            section = back.section;
+            end = output.sections()[section].size();
+        }
+
+        auto first = last - 1;
+        while (first && symbols[order[first - 1]].section == section && symbols[order[first - 1]].value == back.value)
+        {
+            --first;
+        }
+
+        auto global = false;
+
+        for (auto i = first; i < last; ++i)
+        {
+            auto & symbol = symbols[order[i]];
+
+            if (symbol.type != symbol_types::none && !sized[order[i]])
+            {
+                symbol.size = end - symbol.value;
+            }
+
+            global = global || symbol.binding == symbol::bindings::global;
+        }
+
+        end = global ? back.value : end;
+        last = first;
+    }
+}
+
+void reaver::assembler::intel_generator::_report_undefined(const reaver::assembler::ast & tree,
+    const reaver::assembler::module & output, const std::vector<std::uint32_t> & undefined) const
+{
+    std::vector<std::uint32_t> references(output.symbols().size(), no_location);
+
+    auto reference = [&](std::uint32_t symbol, std::uint32_t location)
+    {
+        if (symbol != no_symbol && references[symbol] == no_location)
+        {
+            references[symbol] = location;
+        }
+    };
+
+    for (const auto & statement : tree.statements())
+    {
+        if (auto i = boost::get<instruction>(&statement.value))
+        {
+            for (const auto & op : i->operands)
+            {
+                reference(op.value.symbol, statement.location);
+            }
+        }
+
+        else if (auto d = boost::get<data>(&statement.value))
+        {
+            for (const auto & item : d->items)
+            {
+                reference(item.value.symbol, statement.location);
+            }
+        }
+
+        else if (auto l = boost::get<label>(&statement.value))
+        {
+            reference(l->symbol, statement.location);
+        }
+
+        else if (auto directive = boost::get<global_directive>(&statement.value))
+        {
+            reference(directive->symbol, statement.location);
+        }
+
+        else if (auto directive = boost::get<extern_directive>(&statement.value))
+        {
+            reference(directive->symbol, statement.location);
+        }
+
+        else if (auto directive = boost::get<size_directive>(&statement.value))
+        {
+            reference(directive->symbol, statement.location);
+            reference(directive->size.symbol, statement.location);
+        }
+    }
+
+    for (auto symbol : undefined)
+    {
+        auto name = _front.symbols().name(symbol).to_string();
+
+        _error(references[symbol], output.symbols()[symbol].section == undefined_section ? "symbol `" + name + "` not defined."
+            : "symbol `" + name + "` declared as extern, but defined.");
+    }
+}
+
+void reaver::assembler::intel_generator::_data(const reaver::assembler::data & d, reaver::assembler::section & target) const
+{
+    // zeros only take up space in a section without contents
+    if (target.uninitialized())
+    {
+        for (const auto & item : d.items)
+        {
+            target.extend(item.string.empty() ? d.size : (item.string.size() + d.size - 1) / d.size * d.size);
+        }
+
+        return;
+    }
+
+    auto & bytes = target.bytes();
+
+    for (const auto & item : d.items)
+    {
+        if (!item.string.empty())
+        {
+            bytes.insert(bytes.end(), item.string.begin(), item.string.end());
+
+            // strings in `dw` and wider are padded to a multiple of the item size
+            bytes.resize(bytes.size() + (d.size - item.string.size() % d.size) % d.size, 0);
+            continue;
+        }
+
+        if (!item.value.constant())
+        {
+            target.fixups().push_back({ bytes.size(), item.value.value, item.value.symbol, d.size, fixup::kinds::absolute });
+        }
+
+        auto value = item.value.constant() ? item.value.value : 0;
+
+        for (std::uint8_t i = 0; i < d.size; ++i)
+        {
+            bytes.push_back(static_cast<std::uint8_t>(static_cast<std::uint64_t>(value) >> (8 * i)));
+        }
+    }
+}
+
+// the short form of a branch to a symbol, if it has one and its size wasn't given explicitly
+const reaver::assembler::intel::opcode * reaver::assembler::intel_generator::_short_form(const reaver::assembler::instruction & i,
+    std::uint16_t bits) const
+{
+    if (i.operand_count != 1 || i.operands[0].kind != operand::kinds::immediate || i.operands[0].strict
+        || i.operands[0].value.constant())
+    {
+        return nullptr;
+    }
+
+    auto copy = i;
+    copy.operands[0].classes = rel8;
+
+    auto error = _selection_error::none;
+    return _select(copy, bits, error);
+}
+
+// emits the short form, and keeps the long one aside in case the branch has to grow
+void reaver::assembler::intel_generator::_branch(const reaver::assembler::instruction & i,
+    const reaver::assembler::intel::opcode & form, const reaver::assembler::intel::opcode & short_form, std::uint16_t bits,
+    reaver::assembler::section & output, std::vector<reaver::assembler::relaxable_branch> & branches) const
+{
+    section scratch{ output.name() };
+    intel::encode(i, form, bits, scratch);
+
+    relaxable_branch branch{};
+    branch.offset = output.size();
+    branch.addend = i.operands[0].value.value;
+    branch.symbol = i.operands[0].value.symbol;
+    branch.long_size = scratch.size();
+    branch.field_size = scratch.fixups().back().size;
+    std::copy(scratch.bytes().begin(), scratch.bytes().end(), branch.long_code);
+
+    scratch.bytes().clear();
+    scratch.fixups().clear();
+
+    auto copy = i;
+    copy.operands[0].classes = rel8;
+    intel::encode(copy, short_form, bits, scratch);
+
+    branch.short_size = scratch.size();
+    output.bytes().insert(output.bytes().end(), scratch.bytes().begin(), scratch.bytes().end());
+
+    branches.push_back(branch);
+}
+
+// checks that a mergeable section can be merged, and folds its equal entries
+void reaver::assembler::intel_generator::_merge(reaver::assembler::module & output, std::uint32_t index,
+    const std::vector<std::uint32_t> & defined) const
+{
+    const auto & section = output.sections()[index];
+    auto name = section.name().to_string();
+
+    if (!section.entry_size())
+    {
+        return;
+    }
+
+    if (!section.fixups().empty())
+    {
+        _engine.push(exception(logger::error) << "mergeable section `" << name << "` can't refer to symbols.");
+        return;
+    }
+
+    if (section.size() % section.entry_size())
+    {
+        _engine.push(exception(logger::error) << "size of mergeable section `" << name << "` isn't a multiple of its entry size.");
+        return;
+    }
+
+    if (section.strings() && section.size() && std::any_of(section.bytes().end() - section.entry_size(), section.bytes().end(),
+        [](std::uint8_t byte){ return byte; }))
+    {
+        _engine.push(exception(logger::error) << "the last string of mergeable section `" << name << "` isn't terminated.");
+        return;
+    }
+
+    auto statistics = merge(output, index, defined);
+
+    if (_front.statistics() && statistics.entries)
+    {
+        _engine.push(exception(logger::note) << "merging of `" << name << "`: " << statistics.entries << " entries, "
+            << statistics.folded << " folded.");
+    }
+}
+
+// relative references to symbols defined in the same section don't depend on where the section ends up, so they are
+// filled in right away and only the rest is left for the output
+void reaver::assembler::intel_generator::_resolve(reaver::assembler::module & output) const
+{
+    for (std::uint32_t index = 0; index < output.sections().size(); ++index)
+    {
+        auto & section = output.sections()[index];
+        auto & bytes = section.bytes();
+
+        auto end = std::remove_if(section.fixups().begin(), section.fixups().end(), [&](const fixup & f)
+        {
+            // references to GOT entries are left for the linker, even when their symbols are right here
+            if ((f.kind != fixup::kinds::relative && f.kind != fixup::kinds::branch) || f.symbol == no_symbol
+                || output.symbols()[f.symbol].section != index)
+            {
+                return false;
+            }
+
+            auto value = static_cast<std::int64_t>(output.symbols()[f.symbol].value - f.offset) + f.addend;
+            auto limit = std::int64_t{ 1 } << (8 * f.size - 1);
+
+            if (value < -limit || value >= limit)
+            {
+                _engine.push(exception(logger::error) << "relative reference to `" << _front.symbols().name(f.symbol).to_string()
+                    << "` out of range.");
+            }
+
+            for (std::uint8_t i = 0; i < f.size; ++i)
+            {
+                bytes[f.offset + i] = static_cast<std::uint8_t>(static_cast<std::uint64_t>(value) >> (8 * i));
+            }
+
+            return true;
+        });
+
+        section.fixups().erase(end, section.fixups().end());
+    }
 }
@@ -25,23 +25,52 @@
 #include <reaver/error.h>
 
 #include "../generator.h"
+#include "../relaxation.h"
+#include "../debug.h"
 
 namespace reaver
 {
     namespace assembler
     {
+        namespace intel
+        {
+            struct opcode;
+        }
+
         class intel_generator : public generator
         {
         public:
-            intel_generator(const frontend &, error_engine & engine) : _engine{ engine }
+            intel_generator(const frontend & front, error_engine & engine) : _front{ front }, _engine{ engine }
             {
             }
 
             virtual ~intel_generator() {}
 
-            virtual std::unique_ptr<format::executable::executable> operator()(const ast &) const override;
+            using generator::operator();
+
+            virtual std::unique_ptr<module> operator()(const ast &) const override;
 
         private:
+            struct _chunk;
+            struct _procedure;
+
+            static constexpr std::size_t _chunk_size = 4096;
+
+            void _error(std::uint32_t location, std::string message) const;
+            void _encode(const ast &, _chunk &) const;
+            void _frame(const statement &, std::uint32_t section, const module &, _procedure &) const;
+            std::vector<std::vector<relaxable_branch>> _stitch(const ast &, std::vector<_chunk> &, module &,
+                std::vector<std::vector<std::uint64_t>> & frames, std::vector<line_rows> & lines) const;
+            void _sizes(const ast &, module &, const std::vector<std::size_t> & statements) const;
+            void _report_undefined(const ast &, const module &, const std::vector<std::uint32_t> &) const;
+            void _data(const data &, section &) const;
+            void _merge(module &, std::uint32_t section, const std::vector<std::uint32_t> & defined) const;
+            void _resolve(module &) const;
+            const intel::opcode * _short_form(const instruction &, std::uint16_t bits) const;
+            void _branch(const instruction &, const intel::opcode &, const intel::opcode &, std::uint16_t bits, section &,
+                std::vector<relaxable_branch> &) const;
+
+            const frontend & _front;
             error_engine & _engine;
         };
     }
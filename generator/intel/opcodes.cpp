@@ -0,0 +1,819 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include <algorithm>
+#include <initializer_list>
+
+#include "opcodes.h"
+
+using namespace reaver::assembler::intel;
+using namespace reaver::assembler::operand_classes;
+
+namespace
+{
+    constexpr opcode form(const char * mnemonic, std::initializer_list<operand_class> operands, std::uint16_t modes,
+        std::initializer_list<std::uint8_t> code, std::int8_t rm_index = -1, std::int8_t reg_index = -1, bool special_reg = false)
+    {
+        opcode ret{ mnemonic, { none, none, none }, static_cast<std::uint8_t>(operands.size()), modes, {},
+            static_cast<std::uint8_t>(code.size()), rm_index, reg_index, special_reg };
+
+        for (std::size_t i = 0; i < operands.size(); ++i)
+        {
+            ret.operands[i] = operands.begin()[i];
+        }
+
+        for (std::size_t i = 0; i < code.size(); ++i)
+        {
+            ret.code[i] = code.begin()[i];
+        }
+
+        return ret;
+    }
+
+    // forms of a mnemonic must be kept together; the order within a mnemonic is the order they are tried in
+    constexpr opcode _opcodes[] = {
+            form("add", { al, imm8 }, all, { 0x04 }),
+            form("add", { rm16, simm8 }, all | mode16, { 0x83 }, 0, 0, true),
+            form("add", { rm32, simm8 }, all | mode32, { 0x83 }, 0, 0, true),
+            form("add", { rm64, simm8 }, bits64 | rexw, { 0x83 }, 0, 0, true),
+            form("add", { ax, imm16 }, all | mode16, { 0x05 }),
+            form("add", { eax, imm32 }, all | mode32, { 0x05 }),
+            form("add", { rax, simm32 }, bits64 | rexw, { 0x05 }),
+            form("add", { rm8, imm8 }, all, { 0x80 }, 0, 0, true),
+            form("add", { rm8, imm8 }, bits64 | rex, { 0x80 }, 0, 0, true),
+            form("add", { rm16, imm16 }, all | mode16, { 0x81 }, 0, 0, true),
+            form("add", { rm32, imm32 }, all | mode32, { 0x81 }, 0, 0, true),
+            form("add", { rm64, simm32 }, bits64 | rexw, { 0x81 }, 0, 0, true),
+            form("add", { rm8, r8 }, all, { 0x00 }, 0, 1),
+            form("add", { rm8, r8 }, bits64, { 0x00 }, 0, 1),
+            form("add", { rm16, r16 }, all | mode16, { 0x01 }, 0, 1),
+            form("add", { rm32, r32 }, all | mode32, { 0x01 }, 0, 1),
+            form("add", { rm64, r64 }, bits64 | rexw, { 0x01 }, 0, 1),
+            form("add", { r8, rm8 }, all, { 0x02 }, 1, 0),
+            form("add", { r8, rm8 }, bits64, { 0x02 }, 1, 0),
+            form("add", { r16, rm16 }, all | mode16, { 0x03 }, 1, 0),
+            form("add", { r32, rm32 }, all | mode32, { 0x03 }, 1, 0),
+            form("add", { r64, rm64 }, bits64 | rexw, { 0x03 }, 1, 0),
+
+            form("and", { al, imm8 }, all, { 0x24 }),
+            form("and", { rm16, simm8 }, all | mode16, { 0x83 }, 0, 4, true),
+            form("and", { rm32, simm8 }, all | mode32, { 0x83 }, 0, 4, true),
+            form("and", { rm64, simm8 }, bits64 | rexw, { 0x83 }, 0, 4, true),
+            form("and", { ax, imm16 }, all | mode16, { 0x25 }),
+            form("and", { eax, imm32 }, all | mode32, { 0x25 }),
+            form("and", { rax, simm32 }, bits64 | rexw, { 0x25 }),
+            form("and", { rm8, imm8 }, all, { 0x80 }, 0, 4, true),
+            form("and", { rm8, imm8 }, bits64 | rex, { 0x80 }, 0, 4, true),
+            form("and", { rm16, imm16 }, all | mode16, { 0x81 }, 0, 4, true),
+            form("and", { rm32, imm32 }, all | mode32, { 0x81 }, 0, 4, true),
+            form("and", { rm64, simm32 }, bits64 | rexw, { 0x81 }, 0, 4, true),
+            form("and", { rm8, r8 }, all, { 0x20 }, 0, 1),
+            form("and", { rm8, r8 }, bits64, { 0x20 }, 0, 1),
+            form("and", { rm16, r16 }, all | mode16, { 0x21 }, 0, 1),
+            form("and", { rm32, r32 }, all | mode32, { 0x21 }, 0, 1),
+            form("and", { rm64, r64 }, bits64 | rexw, { 0x21 }, 0, 1),
+            form("and", { r8, rm8 }, all, { 0x22 }, 1, 0),
+            form("and", { r8, rm8 }, bits64, { 0x22 }, 1, 0),
+            form("and", { r16, rm16 }, all | mode16, { 0x23 }, 1, 0),
+            form("and", { r32, rm32 }, all | mode32, { 0x23 }, 1, 0),
+            form("and", { r64, rm64 }, bits64 | rexw, { 0x23 }, 1, 0),
+
+            form("bt", { rm16, r16 }, all | mode16, { 0x0F, 0xA3 }, 0, 1),
+            form("bt", { rm32, r32 }, all | mode32, { 0x0F, 0xA3 }, 0, 1),
+            form("bt", { rm64, r64 }, bits64 | rexw, { 0x0F, 0xA3 }, 0, 1),
+            form("bt", { rm16, imm8 }, all | mode16, { 0x0F, 0xBA }, 0, 4, true),
+            form("bt", { rm32, imm8 }, all | mode32, { 0x0F, 0xBA }, 0, 4, true),
+            form("bt", { rm64, imm8 }, bits64 | rexw, { 0x0F, 0xBA }, 0, 4, true),
+
+            form("btc", { rm16, r16 }, all | mode16, { 0x0F, 0xBB }, 0, 1),
+            form("btc", { rm32, r32 }, all | mode32, { 0x0F, 0xBB }, 0, 1),
+            form("btc", { rm64, r64 }, bits64 | rexw, { 0x0F, 0xBB }, 0, 1),
+            form("btc", { rm16, imm8 }, all | mode16, { 0x0F, 0xBA }, 0, 7, true),
+            form("btc", { rm32, imm8 }, all | mode32, { 0x0F, 0xBA }, 0, 7, true),
+            form("btc", { rm64, imm8 }, bits64 | rexw, { 0x0F, 0xBA }, 0, 7, true),
+
+            form("btr", { rm16, r16 }, all | mode16, { 0x0F, 0xB3 }, 0, 1),
+            form("btr", { rm32, r32 }, all | mode32, { 0x0F, 0xB3 }, 0, 1),
+            form("btr", { rm64, r64 }, bits64 | rexw, { 0x0F, 0xB3 }, 0, 1),
+            form("btr", { rm16, imm8 }, all | mode16, { 0x0F, 0xBA }, 0, 6, true),
+            form("btr", { rm32, imm8 }, all | mode32, { 0x0F, 0xBA }, 0, 6, true),
+            form("btr", { rm64, imm8 }, bits64 | rexw, { 0x0F, 0xBA }, 0, 6, true),
+
+            form("bts", { rm16, r16 }, all | mode16, { 0x0F, 0xAB }, 0, 1),
+            form("bts", { rm32, r32 }, all | mode32, { 0x0F, 0xAB }, 0, 1),
+            form("bts", { rm64, r64 }, bits64 | rexw, { 0x0F, 0xAB }, 0, 1),
+            form("bts", { rm16, imm8 }, all | mode16, { 0x0F, 0xBA }, 0, 5, true),
+            form("bts", { rm32, imm8 }, all | mode32, { 0x0F, 0xBA }, 0, 5, true),
+            form("bts", { rm64, imm8 }, bits64 | rexw, { 0x0F, 0xBA }, 0, 5, true),
+
+            form("call", { rel16 }, bits16 | bits32 | mode16, { 0xE8 }),
+            form("call", { rel32 }, all | mode32, { 0xE8 }),
+            form("call", { rm16 }, bits16 | bits32 | mode16, { 0xFF }, 0, 2, true),
+            form("call", { rm32 }, bits16 | bits32 | mode32, { 0xFF }, 0, 2, true),
+            form("call", { rm64 }, bits64, { 0xFF }, 0, 2, true),
+            form("call", { ptr16_16 }, bits16 | bits32 | mode16, { 0x9A }),
+            form("call", { ptr16_32 }, bits16 | bits32 | mode32, { 0x9A }),
+            form("call", { m16_16 }, all | mode16, { 0xFF }, 0, 3, true),
+            form("call", { m16_32 }, all | mode32, { 0xFF }, 0, 3, true),
+            form("call", { m16_64 }, bits64 | rexw, { 0xFF }, 0, 3, true),
+
+            form("clc", {}, all, { 0xF8 }),
+
+            form("cld", {}, all, { 0xFC }),
+
+            form("cli", {}, all, { 0xFA }),
+
+            form("clts", {}, all, { 0x0F, 0x06 }),
+
+            form("cmc", {}, all, { 0xF5 }),
+
+            form("cmp", { al, imm8 }, all, { 0x3C }),
+            form("cmp", { rm16, simm8 }, all | mode16, { 0x83 }, 0, 7, true),
+            form("cmp", { rm32, simm8 }, all | mode32, { 0x83 }, 0, 7, true),
+            form("cmp", { rm64, simm8 }, bits64 | rexw, { 0x83 }, 0, 7, true),
+            form("cmp", { ax, imm16 }, all | mode16, { 0x3D }),
+            form("cmp", { eax, imm32 }, all | mode32, { 0x3D }),
+            form("cmp", { rax, simm32 }, bits64 | rexw, { 0x3D }),
+            form("cmp", { rm8, imm8 }, all, { 0x80 }, 0, 7, true),
+            form("cmp", { rm8, imm8 }, bits64 | rex, { 0x80 }, 0, 7, true),
+            form("cmp", { rm16, imm16 }, all | mode16, { 0x81 }, 0, 7, true),
+            form("cmp", { rm32, imm32 }, all | mode32, { 0x81 }, 0, 7, true),
+            form("cmp", { rm64, simm32 }, bits64 | rexw, { 0x81 }, 0, 7, true),
+            form("cmp", { rm8, r8 }, all, { 0x38 }, 0, 1),
+            form("cmp", { rm8, r8 }, bits64, { 0x38 }, 0, 1),
+            form("cmp", { rm16, r16 }, all | mode16, { 0x39 }, 0, 1),
+            form("cmp", { rm32, r32 }, all | mode32, { 0x39 }, 0, 1),
+            form("cmp", { rm64, r64 }, bits64 | rexw, { 0x39 }, 0, 1),
+            form("cmp", { r8, rm8 }, all, { 0x3A }, 1, 0),
+            form("cmp", { r8, rm8 }, bits64, { 0x3A }, 1, 0),
+            form("cmp", { r16, rm16 }, all | mode16, { 0x3B }, 1, 0),
+            form("cmp", { r32, rm32 }, all | mode32, { 0x3B }, 1, 0),
+            form("cmp", { r64, rm64 }, bits64 | rexw, { 0x3B }, 1, 0),
+
+            form("cmpxchg", { rm8, r8 }, all, { 0x0F, 0xB0 }, 0, 1),
+            form("cmpxchg", { rm8, r8 }, bits64 | rex, { 0x0F, 0xB0 }, 0, 1),
+            form("cmpxchg", { rm16, r16 }, all | mode16, { 0x0F, 0xB1 }, 0, 1),
+            form("cmpxchg", { rm32, r32 }, all | mode32, { 0x0F, 0xB1 }, 0, 1),
+            form("cmpxchg", { rm64, r64 }, bits64 | rexw, { 0x0F, 0xB1 }, 0, 1),
+
+            form("cpuid", {}, all, { 0x0F, 0xA2 }),
+
+            form("dec", { rm8 }, all, { 0xFE }, 0, 1, true),
+            form("dec", { rm8 }, bits64 | rex, { 0xFE }, 0, 1, true),
+            form("dec", { rm16 }, all | mode16, { 0xFF }, 0, 1, true),
+            form("dec", { rm32 }, all | mode32, { 0xFF }, 0, 1, true),
+            form("dec", { rm64 }, bits64 | rexw, { 0xFF }, 0, 1, true),
+            form("dec", { r16 }, bits16 | bits32 | mode16 | rw, { 0x48 }),
+            form("dec", { r32 }, bits16 | bits32 | mode32 | rd, { 0x48 }),
+
+            form("div", { rm8 }, all, { 0xF6 }, 0, 6, true),
+            form("div", { rm8 }, bits64 | rex, { 0xF6 }, 0, 6, true),
+            form("div", { rm16 }, all | mode16, { 0xF7 }, 0, 6, true),
+            form("div", { rm32 }, all | mode32, { 0xF7 }, 0, 6, true),
+            form("div", { rm64 }, bits64 | rexw, { 0xF7 }, 0, 6, true),
+
+            form("enter", { imm16, imm8 }, all, { 0xC8 }),
+
+            form("hlt", {}, all, { 0xF4 }),
+
+            form("idiv", { rm8 }, all, { 0xF6 }, 0, 7, true),
+            form("idiv", { rm8 }, bits64 | rex, { 0xF6 }, 0, 7, true),
+            form("idiv", { rm16 }, all | mode16, { 0xF7 }, 0, 7, true),
+            form("idiv", { rm32 }, all | mode32, { 0xF7 }, 0, 7, true),
+            form("idiv", { rm64 }, bits64 | rexw, { 0xF7 }, 0, 7, true),
+
+            form("imul", { rm8 }, all, { 0xF6 }, 0, 5, true),
+            form("imul", { rm16 }, all | mode16, { 0xF7 }, 0, 5, true),
+            form("imul", { rm32 }, all | mode32, { 0xF7 }, 0, 5, true),
+            form("imul", { rm64 }, bits64 | rexw, { 0xF7 }, 0, 5, true),
+            form("imul", { r16, rm16 }, all | mode16, { 0x0F, 0xAF }, 1, 0),
+            form("imul", { r32, rm32 }, all | mode32, { 0x0F, 0xAF }, 1, 0),
+            form("imul", { r64, rm64 }, bits64 | rexw, { 0x0F, 0xAF }, 1, 0),
+            form("imul", { r16, rm16, simm8 }, all | mode16, { 0x6B }, 1, 0),
+            form("imul", { r32, rm32, simm8 }, all | mode32, { 0x6B }, 1, 0),
+            form("imul", { r64, rm64, simm8 }, bits64 | rexw, { 0x6B }, 1, 0),
+            form("imul", { r16, rm16, imm16 }, all | mode16, { 0x69 }, 1, 0),
+            form("imul", { r32, rm32, imm32 }, all | mode32, { 0x69 }, 1, 0),
+            form("imul", { r64, rm64, simm32 }, bits64 | rexw, { 0x69 }, 1, 0),
+
+            form("in", { al, imm8 }, all, { 0xE4 }),
+            form("in", { ax, imm8 }, all | mode16, { 0xE5 }),
+            form("in", { eax, imm8 }, all | mode32, { 0xE5 }),
+            form("in", { al, dx }, all, { 0xEC }),
+            form("in", { ax, dx }, all | mode16, { 0xED }),
+            form("in", { eax, dx }, all | mode32, { 0xED }),
+
+            form("inc", { rm8 }, all, { 0xFE }, 0, 0, true),
+            form("inc", { rm8 }, bits64 | rex, { 0xFE }, 0, 0, true),
+            form("inc", { rm16 }, all | mode16, { 0xFF }, 0, 0, true),
+            form("inc", { rm32 }, all | mode32, { 0xFF }, 0, 0, true),
+            form("inc", { rm64 }, bits64 | rexw, { 0xFF }, 0, 0, true),
+            form("inc", { r16 }, bits16 | bits32 | mode16 | rw, { 0x40 }),
+            form("inc", { r32 }, bits16 | bits32 | mode32 | rd, { 0x40 }),
+
+            form("int", { imm8 }, all, { 0xCD }),
+
+            form("int3", {}, all, { 0xCC }),
+
+            form("into", {}, all, { 0xCE }),
+
+            form("iret", {}, all, { 0xCF }),
+
+            form("iretd", {}, all | mode32, { 0xCF }),
+
+            form("iretq", {}, bits64 | rexw, { 0xCF }),
+
+            form("ja", { rel8 }, all, { 0x77 }),
+            form("ja", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x87 }),
+            form("ja", { rel32 }, all | mode32, { 0x0F, 0x87 }),
+
+            form("jae", { rel8 }, all, { 0x73 }),
+            form("jae", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x83 }),
+            form("jae", { rel32 }, all | mode32, { 0x0F, 0x83 }),
+
+            form("jb", { rel8 }, all, { 0x72 }),
+            form("jb", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x82 }),
+            form("jb", { rel32 }, all | mode32, { 0x0F, 0x82 }),
+
+            form("jbe", { rel8 }, all, { 0x76 }),
+            form("jbe", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x86 }),
+            form("jbe", { rel32 }, all | mode32, { 0x0F, 0x86 }),
+
+            form("jc", { rel8 }, all, { 0x72 }),
+            form("jc", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x82 }),
+            form("jc", { rel32 }, all | mode32, { 0x0F, 0x82 }),
+
+            form("jcxz", { rel8 }, bits16 | bits32 | mode16, { 0xE3 }),
+
+            form("je", { rel8 }, all, { 0x74 }),
+            form("je", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x84 }),
+            form("je", { rel32 }, all | mode32, { 0x0F, 0x84 }),
+
+            form("jecxz", { rel8 }, bits16 | bits32 | mode32, { 0xE3 }),
+            form("jecxz", { rel8 }, bits64 | mode32, { 0xE3 }),
+
+            form("jg", { rel8 }, all, { 0x7F }),
+            form("jg", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x8F }),
+            form("jg", { rel32 }, all | mode32, { 0x0F, 0x8F }),
+
+            form("jge", { rel8 }, all, { 0x7D }),
+            form("jge", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x8D }),
+            form("jge", { rel32 }, all | mode32, { 0x0F, 0x8D }),
+
+            form("jl", { rel8 }, all, { 0x7C }),
+            form("jl", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x8C }),
+            form("jl", { rel32 }, all | mode32, { 0x0F, 0x8C }),
+
+            form("jle", { rel8 }, all, { 0x7E }),
+            form("jle", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x8E }),
+            form("jle", { rel32 }, all | mode32, { 0x0F, 0x8E }),
+
+            form("jmp", { rel8 }, all, { 0xEB }),
+            form("jmp", { rel16 }, bits16 | bits32 | mode16, { 0xE9 }),
+            form("jmp", { rel32 }, all | mode32, { 0xE9 }),
+            form("jmp", { rm16 }, bits16 | bits32 | mode16, { 0xFF }, 0, 4, true),
+            form("jmp", { rm32 }, bits16 | bits32 | mode32, { 0xFF }, 0, 4, true),
+            form("jmp", { rm64 }, bits64, { 0xFF }, 0, 4, true),
+            form("jmp", { ptr16_16 }, bits16 | bits32 | mode16, { 0xEA }),
+            form("jmp", { ptr16_32 }, bits16 | bits32 | mode32, { 0xEA }),
+            form("jmp", { m16_16 }, all | mode16, { 0xFF }, 0, 5, true),
+            form("jmp", { m16_32 }, all | mode32, { 0xFF }, 0, 5, true),
+            form("jmp", { m16_64 }, bits64 | rexw, { 0xFF }, 0, 5, true),
+
+            form("jna", { rel8 }, all, { 0x76 }),
+            form("jna", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x86 }),
+            form("jna", { rel32 }, all | mode32, { 0x0F, 0x86 }),
+
+            form("jnae", { rel8 }, all, { 0x72 }),
+            form("jnae", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x82 }),
+            form("jnae", { rel32 }, all | mode32, { 0x0F, 0x82 }),
+
+            form("jnb", { rel8 }, all, { 0x73 }),
+            form("jnb", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x83 }),
+            form("jnb", { rel32 }, all | mode32, { 0x0F, 0x83 }),
+
+            form("jnbe", { rel8 }, all, { 0x77 }),
+            form("jnbe", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x87 }),
+            form("jnbe", { rel32 }, all | mode32, { 0x0F, 0x87 }),
+
+            form("jnc", { rel8 }, all, { 0x73 }),
+            form("jnc", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x83 }),
+            form("jnc", { rel32 }, all | mode32, { 0x0F, 0x83 }),
+
+            form("jne", { rel8 }, all, { 0x75 }),
+            form("jne", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x85 }),
+            form("jne", { rel32 }, all | mode32, { 0x0F, 0x85 }),
+
+            form("jng", { rel8 }, all, { 0x7E }),
+            form("jng", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x8E }),
+            form("jng", { rel32 }, all | mode32, { 0x0F, 0x8E }),
+
+            form("jnge", { rel8 }, all, { 0x7C }),
+            form("jnge", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x8C }),
+            form("jnge", { rel32 }, all | mode32, { 0x0F, 0x8C }),
+
+            form("jnl", { rel8 }, all, { 0x7D }),
+            form("jnl", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x8D }),
+            form("jnl", { rel32 }, all | mode32, { 0x0F, 0x8D }),
+
+            form("jnle", { rel8 }, all, { 0x7F }),
+            form("jnle", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x8F }),
+            form("jnle", { rel32 }, all | mode32, { 0x0F, 0x8F }),
+
+            form("jno", { rel8 }, all, { 0x71 }),
+            form("jno", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x81 }),
+            form("jno", { rel32 }, all | mode32, { 0x0F, 0x81 }),
+
+            form("jnp", { rel8 }, all, { 0x7B }),
+            form("jnp", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x8B }),
+            form("jnp", { rel32 }, all | mode32, { 0x0F, 0x8B }),
+
+            form("jns", { rel8 }, all, { 0x79 }),
+            form("jns", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x89 }),
+            form("jns", { rel32 }, all | mode32, { 0x0F, 0x89 }),
+
+            form("jnz", { rel8 }, all, { 0x75 }),
+            form("jnz", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x85 }),
+            form("jnz", { rel32 }, all | mode32, { 0x0F, 0x85 }),
+
+            form("jo", { rel8 }, all, { 0x70 }),
+            form("jo", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x80 }),
+            form("jo", { rel32 }, all | mode32, { 0x0F, 0x80 }),
+
+            form("jp", { rel8 }, all, { 0x7A }),
+            form("jp", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x8A }),
+            form("jp", { rel32 }, all | mode32, { 0x0F, 0x8A }),
+
+            form("jpe", { rel8 }, all, { 0x7A }),
+            form("jpe", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x8A }),
+            form("jpe", { rel32 }, all | mode32, { 0x0F, 0x8A }),
+
+            form("jpo", { rel8 }, all, { 0x7B }),
+            form("jpo", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x8B }),
+            form("jpo", { rel32 }, all | mode32, { 0x0F, 0x8B }),
+
+            form("jrcxz", { rel8 }, bits64, { 0xE3 }),
+
+            form("js", { rel8 }, all, { 0x78 }),
+            form("js", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x88 }),
+            form("js", { rel32 }, all | mode32, { 0x0F, 0x88 }),
+
+            form("jz", { rel8 }, all, { 0x74 }),
+            form("jz", { rel16 }, bits16 | bits32 | mode16, { 0x0F, 0x84 }),
+            form("jz", { rel32 }, all | mode32, { 0x0F, 0x84 }),
+
+            form("lea", { r16, m }, all | mode16, { 0x8D }, 1, 0),
+            form("lea", { r32, m }, all | mode32, { 0x8D }, 1, 0),
+            form("lea", { r64, m }, bits64 | rexw, { 0x8D }, 1, 0),
+
+            form("leave", {}, all, { 0xC9 }),
+
+            form("lfence", {}, all, { 0x0F, 0xAE, 0xE8 }),
+
+            form("lgdt", { m }, bits16 | bits32, { 0x0F, 0x01 }, 0, 2, true),
+            form("lgdt", { m }, bits64, { 0x0F, 0x01 }, 0, 2, true),
+
+            form("lidt", { m }, bits16 | bits32, { 0x0F, 0x01 }, 0, 3, true),
+            form("lidt", { m }, bits64, { 0x0F, 0x01 }, 0, 3, true),
+
+            form("lldt", { rm16 }, all, { 0x0F, 0x00 }, 0, 2, true),
+
+            form("lock", {}, all, { 0xF0 }),
+
+            form("lsl", { r16, r16m16 }, all | mode16, { 0x0F, 0x03 }, 1, 0),
+            form("lsl", { r32, r32m16 }, all | mode32, { 0x0F, 0x03 }, 1, 0),
+            form("lsl", { r64, r32m16 }, bits64 | rexw, { 0x0F, 0x03 }, 1, 0),
+
+            form("ltr", { rm16 }, all, { 0x0F, 0x00 }, 0, 3, true),
+
+            form("mfence", {}, all, { 0x0F, 0xAE, 0xF0 }),
+
+            form("mov", { rm8, r8 }, all, { 0x88 }, 0, 1),
+            form("mov", { rm8, r8 }, bits64 | rex, { 0x88 }, 0, 1),
+            form("mov", { rm16, r16 }, all | mode16, { 0x89 }, 0, 1),
+            form("mov", { rm32, r32 }, all | mode32, { 0x89 }, 0, 1),
+            form("mov", { rm64, r64 }, bits64 | rexw, { 0x89 }, 0, 1),
+            form("mov", { r8, rm8 }, all, { 0x8A }, 1, 0),
+            form("mov", { r8, rm8 }, bits64 | rex, { 0x8A }, 1, 0),
+            form("mov", { r16, rm16 }, all | mode16, { 0x8B }, 1, 0),
+            form("mov", { r32, rm32 }, all | mode32, { 0x8B }, 1, 0),
+            form("mov", { r64, rm64 }, bits64 | rexw, { 0x8B }, 1, 0),
+            form("mov", { rm16, sreg }, all, { 0x8C }, 0, 1),
+            form("mov", { rm32, sreg }, all, { 0x8C }, 0, 1),
+            form("mov", { rm64, sreg }, bits64 | rexw, { 0x8C }, 0, 1),
+            form("mov", { sreg, rm16 }, all, { 0x8E }, 1, 0),
+            form("mov", { sreg, rm32 }, all, { 0x8E }, 1, 0),
+            form("mov", { sreg, rm64 }, bits64 | rexw, { 0x8E }, 1, 0),
+            form("mov", { r8, imm8 }, all | rb, { 0xB0 }),
+            form("mov", { r8, imm8 }, bits64 | rb | rex, { 0xB0 }),
+            form("mov", { r16, imm16 }, all | mode16 | rw, { 0xB8 }),
+            form("mov", { r32, imm32 }, all | mode32 | rd, { 0xB8 }),
+            form("mov", { rm8, imm8 }, all, { 0xC6 }, 0, 0, true),
+            form("mov", { rm8, imm8 }, bits64 | rex, { 0xC6 }, 0, 0, true),
+            form("mov", { rm16, imm16 }, all | mode16, { 0xC7 }, 0, 0, true),
+            form("mov", { rm32, imm32 }, all | mode32, { 0xC7 }, 0, 0, true),
+            form("mov", { rm64, simm32 }, bits64 | rexw, { 0xC7 }, 0, 0, true),
+            form("mov", { r64, imm64 }, bits64 | rexw | rd, { 0xB8 }),
+            form("mov", { r32, creg }, bits16 | bits32, { 0x0F, 0x20 }, 0, 1),
+            form("mov", { r64, creg }, bits64, { 0x0F, 0x20 }, 0, 1),
+            form("mov", { r64, cr8 }, bits64 | rexr, { 0x0F, 0x20 }, 0, 0, true),
+            form("mov", { creg, r32 }, bits16 | bits32, { 0x0F, 0x22 }, 1, 0),
+            form("mov", { creg, r64 }, bits64, { 0x0F, 0x22 }, 1, 0),
+            form("mov", { cr8, r64 }, bits64 | rexr, { 0x0F, 0x22 }, 1, 0, true),
+            form("mov", { r32, dreg }, bits16 | bits32, { 0x0F, 0x21 }, 0, 1),
+            form("mov", { r64, dreg }, bits64, { 0x0F, 0x21 }, 0, 1),
+            form("mov", { dreg, r32 }, bits16 | bits32, { 0x0F, 0x23 }, 1, 0),
+            form("mov", { dreg, r64 }, bits64, { 0x0F, 0x23 }, 1, 0),
+
+            form("movzx", { r16, rm8 }, all | mode16, { 0x0F, 0xB6 }, 1, 0),
+            form("movzx", { r32, rm8 }, all | mode32, { 0x0F, 0xB6 }, 1, 0),
+            form("movzx", { r64, rm8 }, bits64 | rexw, { 0x0F, 0xB6 }, 1, 0),
+            form("movzx", { r32, rm16 }, all | mode32, { 0x0F, 0xB7 }, 1, 0),
+            form("movzx", { r64, rm16 }, bits64 | rexw, { 0x0F, 0xB7 }, 1, 0),
+
+            form("mul", { rm8 }, all, { 0xF6 }, 0, 4, true),
+            form("mul", { rm8 }, bits64 | rex, { 0xF6 }, 0, 4, true),
+            form("mul", { rm16 }, all | mode16, { 0xF7 }, 0, 4, true),
+            form("mul", { rm32 }, all | mode32, { 0xF7 }, 0, 4, true),
+            form("mul", { rm64 }, bits64 | rexw, { 0xF7 }, 0, 4, true),
+
+            form("neg", { rm8 }, all, { 0xF6 }, 0, 3, true),
+            form("neg", { rm8 }, bits64 | rex, { 0xF6 }, 0, 3, true),
+            form("neg", { rm16 }, all | mode16, { 0xF7 }, 0, 3, true),
+            form("neg", { rm32 }, all | mode32, { 0xF7 }, 0, 3, true),
+            form("neg", { rm64 }, bits64 | rexw, { 0xF7 }, 0, 3, true),
+
+            form("nop", {}, all, { 0x90 }),
+            form("nop", { rm16 }, all | mode16, { 0x0F, 0x1F }, 0, 0, true),
+            form("nop", { rm32 }, all | mode32, { 0x0F, 0x1F }, 0, 0, true),
+
+            form("not", { rm8 }, all, { 0xF6 }, 0, 2, true),
+            form("not", { rm8 }, bits64 | rex, { 0xF6 }, 0, 2, true),
+            form("not", { rm16 }, all | mode16, { 0xF7 }, 0, 2, true),
+            form("not", { rm32 }, all | mode32, { 0xF7 }, 0, 2, true),
+            form("not", { rm64 }, bits64 | rexw, { 0xF7 }, 0, 2, true),
+
+            form("or", { al, imm8 }, all, { 0x0C }),
+            form("or", { rm16, simm8 }, all | mode16, { 0x83 }, 0, 1, true),
+            form("or", { rm32, simm8 }, all | mode32, { 0x83 }, 0, 1, true),
+            form("or", { rm64, simm8 }, bits64 | rexw, { 0x83 }, 0, 1, true),
+            form("or", { ax, imm16 }, all | mode16, { 0x0D }),
+            form("or", { eax, imm32 }, all | mode32, { 0x0D }),
+            form("or", { rax, simm32 }, bits64 | rexw, { 0x0D }),
+            form("or", { rm8, imm8 }, all, { 0x80 }, 0, 1, true),
+            form("or", { rm8, imm8 }, bits64 | rex, { 0x80 }, 0, 1, true),
+            form("or", { rm16, imm16 }, all | mode16, { 0x81 }, 0, 1, true),
+            form("or", { rm32, imm32 }, all | mode32, { 0x81 }, 0, 1, true),
+            form("or", { rm64, simm32 }, bits64 | rexw, { 0x81 }, 0, 1, true),
+            form("or", { rm8, r8 }, all, { 0x08 }, 0, 1),
+            form("or", { rm8, r8 }, bits64, { 0x08 }, 0, 1),
+            form("or", { rm16, r16 }, all | mode16, { 0x09 }, 0, 1),
+            form("or", { rm32, r32 }, all | mode32, { 0x09 }, 0, 1),
+            form("or", { rm64, r64 }, bits64 | rexw, { 0x09 }, 0, 1),
+            form("or", { r8, rm8 }, all, { 0x0A }, 1, 0),
+            form("or", { r8, rm8 }, bits64, { 0x0A }, 1, 0),
+            form("or", { r16, rm16 }, all | mode16, { 0x0B }, 1, 0),
+            form("or", { r32, rm32 }, all | mode32, { 0x0B }, 1, 0),
+            form("or", { r64, rm64 }, bits64 | rexw, { 0x0B }, 1, 0),
+
+            form("out", { imm8, al }, all, { 0xE6 }),
+            form("out", { imm8, ax }, all | mode16, { 0xE7 }),
+            form("out", { imm8, eax }, all | mode32, { 0xE7 }),
+            form("out", { dx, al }, all, { 0xEE }),
+            form("out", { dx, ax }, all | mode16, { 0xEF }),
+            form("out", { dx, eax }, all | mode32, { 0xEF }),
+
+            form("pause", {}, all, { 0xF3, 0x90 }),
+
+            form("pop", { rm16 }, all | mode16, { 0x8F }, 0, 0, true),
+            form("pop", { rm32 }, bits16 | bits32 | mode32, { 0x8F }, 0, 0, true),
+            form("pop", { rm64 }, bits64, { 0x8F }, 0, 0, true),
+            form("pop", { r16 }, all | mode16 | rw, { 0x58 }),
+            form("pop", { r32 }, bits16 | bits32 | mode32 | rd, { 0x58 }),
+            form("pop", { r64 }, bits64 | rd, { 0x58 }),
+            form("pop", { ds }, bits16 | bits32, { 0x1F }),
+            form("pop", { es }, bits16 | bits32, { 0x07 }),
+            form("pop", { ss }, bits16 | bits32, { 0x17 }),
+            form("pop", { fs }, bits64, { 0x0F, 0xA1 }),
+            form("pop", { fs }, all | mode16, { 0x0F, 0xA1 }),
+            form("pop", { fs }, bits16 | bits32 | mode32, { 0x0F, 0xA1 }),
+            form("pop", { gs }, bits64, { 0x0F, 0xA9 }),
+            form("pop", { gs }, all | mode16, { 0x0F, 0xA9 }),
+            form("pop", { gs }, bits16 | bits32 | mode32, { 0x0F, 0xA9 }),
+
+            form("popa", {}, bits16 | bits32 | mode16, { 0x61 }),
+
+            form("popad", {}, bits16 | bits32 | mode32, { 0x61 }),
+
+            form("push", { rm16 }, all | mode16, { 0xFF }, 0, 6, true),
+            form("push", { rm32 }, bits16 | bits32 | mode32, { 0xFF }, 0, 6, true),
+            form("push", { rm64 }, bits64, { 0xFF }, 0, 6, true),
+            form("push", { r16 }, all | mode16 | rw, { 0x50 }),
+            form("push", { r32 }, bits16 | bits32 | mode32 | rd, { 0x50 }),
+            form("push", { r64 }, bits64 | rd, { 0x50 }),
+            form("push", { simm8 }, all, { 0x6A }),
+            form("push", { imm16 }, all | mode16, { 0x68 }),
+            form("push", { imm32 }, all | mode32, { 0x68 }),
+            form("push", { ds }, bits16 | bits32, { 0x1E }),
+            form("push", { es }, bits16 | bits32, { 0x06 }),
+            form("push", { ss }, bits16 | bits32, { 0x16 }),
+            form("push", { fs }, bits64, { 0x0F, 0xA0 }),
+            form("push", { fs }, all | mode16, { 0x0F, 0xA0 }),
+            form("push", { fs }, bits16 | bits32 | mode32, { 0x0F, 0xA0 }),
+            form("push", { gs }, bits64, { 0x0F, 0xA8 }),
+            form("push", { gs }, all | mode16, { 0x0F, 0xA8 }),
+            form("push", { gs }, bits16 | bits32 | mode32, { 0x0F, 0xA8 }),
+
+            form("rdtsc", {}, all, { 0x0F, 0x31 }),
+
+            form("rdtscp", {}, all, { 0x0F, 0x01, 0xF9 }),
+
+            form("ret", {}, all, { 0xC3 }),
+            form("ret", { imm16 }, all, { 0xC2 }),
+
+            form("retf", {}, all, { 0xCB }),
+            form("retf", { imm16 }, all, { 0xCA }),
+
+            form("sfence", {}, all, { 0x0F, 0xAE, 0xF8 }),
+
+            form("stc", {}, all, { 0xF9 }),
+
+            form("std", {}, all, { 0xFD }),
+
+            form("sti", {}, all, { 0xFB }),
+
+            form("sub", { al, imm8 }, all, { 0x2C }),
+            form("sub", { rm16, simm8 }, all | mode16, { 0x83 }, 0, 5, true),
+            form("sub", { rm32, simm8 }, all | mode32, { 0x83 }, 0, 5, true),
+            form("sub", { rm64, simm8 }, bits64 | rexw, { 0x83 }, 0, 5, true),
+            form("sub", { ax, imm16 }, all | mode16, { 0x2D }),
+            form("sub", { eax, imm32 }, all | mode32, { 0x2D }),
+            form("sub", { rax, simm32 }, bits64 | rexw, { 0x2D }),
+            form("sub", { rm8, imm8 }, all, { 0x80 }, 0, 5, true),
+            form("sub", { rm8, imm8 }, bits64 | rex, { 0x80 }, 0, 5, true),
+            form("sub", { rm16, imm16 }, all | mode16, { 0x81 }, 0, 5, true),
+            form("sub", { rm32, imm32 }, all | mode32, { 0x81 }, 0, 5, true),
+            form("sub", { rm64, simm32 }, bits64 | rexw, { 0x81 }, 0, 5, true),
+            form("sub", { rm8, r8 }, all, { 0x28 }, 0, 1),
+            form("sub", { rm8, r8 }, bits64, { 0x28 }, 0, 1),
+            form("sub", { rm16, r16 }, all | mode16, { 0x29 }, 0, 1),
+            form("sub", { rm32, r32 }, all | mode32, { 0x29 }, 0, 1),
+            form("sub", { rm64, r64 }, bits64 | rexw, { 0x29 }, 0, 1),
+            form("sub", { r8, rm8 }, all, { 0x2A }, 1, 0),
+            form("sub", { r8, rm8 }, bits64, { 0x2A }, 1, 0),
+            form("sub", { r16, rm16 }, all | mode16, { 0x2B }, 1, 0),
+            form("sub", { r32, rm32 }, all | mode32, { 0x2B }, 1, 0),
+            form("sub", { r64, rm64 }, bits64 | rexw, { 0x2B }, 1, 0),
+
+            form("syscall", {}, bits64, { 0x0F, 0x05 }),
+
+            form("sysenter", {}, all, { 0x0F, 0x34 }),
+
+            form("sysexit", {}, all, { 0x0F, 0x35 }),
+
+            form("sysexitq", {}, bits64 | rexw, { 0x0F, 0x35 }),
+
+            form("sysret", {}, all, { 0x0F, 0x07 }),
+
+            form("sysretq", {}, bits64 | rexw, { 0x0F, 0x07 }),
+
+            form("test", { al, imm8 }, all, { 0xA8 }),
+            form("test", { ax, imm16 }, all | mode16, { 0xA9 }),
+            form("test", { eax, imm32 }, all | mode32, { 0xA9 }),
+            form("test", { rax, simm32 }, bits64 | rexw, { 0xA9 }),
+            form("test", { rm8, imm8 }, all, { 0xF6 }, 0, 0, true),
+            form("test", { rm8, imm8 }, bits64 | rex, { 0xF6 }, 0, 0, true),
+            form("test", { rm16, imm16 }, all | mode16, { 0xF7 }, 0, 0, true),
+            form("test", { rm32, imm32 }, all | mode32, { 0xF7 }, 0, 0, true),
+            form("test", { rm64, simm32 }, bits64 | rexw, { 0xF7 }, 0, 0, true),
+            form("test", { rm8, r8 }, all, { 0x84 }, 0, 1),
+            form("test", { rm8, r8 }, bits64 | rex, { 0x84 }, 0, 1),
+            form("test", { rm16, r16 }, all | mode16, { 0x85 }, 0, 1),
+            form("test", { rm32, r32 }, all | mode32, { 0x85 }, 0, 1),
+            form("test", { rm64, r64 }, bits64 | rexw, { 0x85 }, 0, 1),
+
+            form("xor", { al, imm8 }, all, { 0x34 }),
+            form("xor", { rm16, simm8 }, all | mode16, { 0x83 }, 0, 6, true),
+            form("xor", { rm32, simm8 }, all | mode32, { 0x83 }, 0, 6, true),
+            form("xor", { rm64, simm8 }, bits64 | rexw, { 0x83 }, 0, 6, true),
+            form("xor", { ax, imm16 }, all | mode16, { 0x35 }),
+            form("xor", { eax, imm32 }, all | mode32, { 0x35 }),
+            form("xor", { rax, simm32 }, bits64 | rexw, { 0x35 }),
+            form("xor", { rm8, imm8 }, all, { 0x80 }, 0, 6, true),
+            form("xor", { rm8, imm8 }, bits64 | rex, { 0x80 }, 0, 6, true),
+            form("xor", { rm16, imm16 }, all | mode16, { 0x81 }, 0, 6, true),
+            form("xor", { rm32, imm32 }, all | mode32, { 0x81 }, 0, 6, true),
+            form("xor", { rm64, simm32 }, bits64 | rexw, { 0x81 }, 0, 6, true),
+            form("xor", { rm8, r8 }, all, { 0x30 }, 0, 1),
+            form("xor", { rm8, r8 }, bits64 | rex, { 0x30 }, 0, 1),
+            form("xor", { rm16, r16 }, all | mode16, { 0x31 }, 0, 1),
+            form("xor", { rm32, r32 }, all | mode32, { 0x31 }, 0, 1),
+            form("xor", { rm64, r64 }, bits64 | rexw, { 0x31 }, 0, 1),
+            form("xor", { r8, rm8 }, all, { 0x32 }, 1, 0),
+            form("xor", { r8, rm8 }, bits64 | rex, { 0x32 }, 1, 0),
+            form("xor", { r16, rm16 }, all | mode16, { 0x33 }, 1, 0),
+            form("xor", { r32, rm32 }, all | mode32, { 0x33 }, 1, 0),
+            form("xor", { r64, rm64 }, bits64 | rexw, { 0x33 }, 1, 0)
+    };
+
+    constexpr std::size_t _opcode_count = sizeof(_opcodes) / sizeof(*_opcodes);
+
+    constexpr std::size_t _max_mnemonics = 128;
+    constexpr std::size_t _slot_count = 256;
+    constexpr std::size_t _bucket_count = 64;
+
+    constexpr std::size_t _length(const char * str)
+    {
+        std::size_t ret = 0;
+        while (str[ret])
+        {
+            ++ret;
+        }
+        return ret;
+    }
+
+    constexpr bool _equal(const char * lhs, const char * rhs)
+    {
+        while (*lhs && *lhs == *rhs)
+        {
+            ++lhs;
+            ++rhs;
+        }
+        return *lhs == *rhs;
+    }
+
+    // FNV-1a; the low bits pick the bucket, the rest drive the displaced probe
+    constexpr std::uint32_t _hash(const char * str, std::size_t length)
+    {
+        std::uint32_t ret = 2166136261u;
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            ret ^= static_cast<std::uint8_t>(str[i]);
+            ret *= 16777619u;
+        }
+        return ret;
+    }
+
+    constexpr std::size_t _slot(std::uint32_t hash, std::uint8_t displacement)
+    {
+        return ((hash >> 8) + displacement * ((hash >> 16) | 1)) % _slot_count;
+    }
+
+    struct _mnemonic_list
+    {
+        mnemonic mnemonics[_max_mnemonics];
+        std::size_t size;
+    };
+
+    constexpr _mnemonic_list _collect()
+    {
+        _mnemonic_list ret{ {}, 0 };
+
+        for (std::size_t i = 0; i < _opcode_count; ++i)
+        {
+            if (ret.size && _equal(ret.mnemonics[ret.size - 1].name, _opcodes[i].mnemonic))
+            {
+                ++ret.mnemonics[ret.size - 1].count;
+                continue;
+            }
+
+            if (ret.size == _max_mnemonics)
+            {
+                throw "too many mnemonics; bump _max_mnemonics and _slot_count";
+            }
+
+            ret.mnemonics[ret.size++] = { _opcodes[i].mnemonic, static_cast<std::uint8_t>(_length(_opcodes[i].mnemonic)), 1,
+                static_cast<std::uint16_t>(i) };
+        }
+
+        return ret;
+    }
+
+    constexpr _mnemonic_list _mnemonics = _collect();
+
+    struct _index
+    {
+        std::uint8_t displacements[_bucket_count];
+        mnemonic slots[_slot_count];
+    };
+
+    // hash and displace: buckets are placed largest first, each one searching for a displacement that lands all of its
+    // mnemonics in free slots; a mnemonic split into two runs in the table shows up here as an unplaceable bucket
+    constexpr _index _build_index()
+    {
+        _index ret{};
+
+        std::uint32_t hashes[_max_mnemonics] = {};
+        std::size_t bucket_sizes[_bucket_count] = {};
+        std::size_t max_bucket_size = 0;
+
+        for (std::size_t i = 0; i < _mnemonics.size; ++i)
+        {
+            hashes[i] = _hash(_mnemonics.mnemonics[i].name, _mnemonics.mnemonics[i].length);
+            auto & size = bucket_sizes[hashes[i] % _bucket_count];
+            max_bucket_size = std::max(max_bucket_size, ++size);
+        }
+
+        bool taken[_slot_count] = {};
+
+        for (std::size_t size = max_bucket_size; size > 0; --size)
+        {
+            for (std::size_t bucket = 0; bucket < _bucket_count; ++bucket)
+            {
+                if (bucket_sizes[bucket] != size)
+                {
+                    continue;
+                }
+
+                std::size_t members[_max_mnemonics] = {};
+                std::size_t member_count = 0;
+                for (std::size_t i = 0; i < _mnemonics.size; ++i)
+                {
+                    if (hashes[i] % _bucket_count == bucket)
+                    {
+                        members[member_count++] = i;
+                    }
+                }
+
+                std::size_t displacement = 0;
+                for (; displacement < 256; ++displacement)
+                {
+                    bool placed = true;
+                    for (std::size_t i = 0; i < member_count && placed; ++i)
+                    {
+                        auto slot = _slot(hashes[members[i]], displacement);
+                        placed = !taken[slot];
+                        for (std::size_t j = 0; j < i && placed; ++j)
+                        {
+                            placed = _slot(hashes[members[j]], displacement) != slot;
+                        }
+                    }
+
+                    if (placed)
+                    {
+                        break;
+                    }
+                }
+
+                if (displacement == 256)
+                {
+                    throw "cannot build a perfect hash for the mnemonic table";
+                }
+
+                ret.displacements[bucket] = displacement;
+                for (std::size_t i = 0; i < member_count; ++i)
+                {
+                    auto slot = _slot(hashes[members[i]], displacement);
+                    taken[slot] = true;
+                    ret.slots[slot] = _mnemonics.mnemonics[members[i]];
+                }
+            }
+        }
+
+        return ret;
+    }
+
+    constexpr _index _mnemonic_index = _build_index();
+}
+
+const reaver::assembler::intel::opcode * reaver::assembler::intel::mnemonic::begin() const
+{
+    return _opcodes + first;
+}
+
+const reaver::assembler::intel::opcode * reaver::assembler::intel::mnemonic::end() const
+{
+    return _opcodes + first + count;
+}
+
+const reaver::assembler::intel::mnemonic * reaver::assembler::intel::find_mnemonic(boost::string_ref name)
+{
+    auto hash = _hash(name.data(), name.size());
+    auto & entry = _mnemonic_index.slots[_slot(hash, _mnemonic_index.displacements[hash % _bucket_count])];
+
+    if (entry.count && entry.length == name.size() && std::equal(name.begin(), name.end(), entry.name))
+    {
+        return &entry;
+    }
+
+    return nullptr;
+}
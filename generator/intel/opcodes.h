@@ -0,0 +1,85 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <cstdint>
+
+#include <boost/utility/string_ref.hpp>
+
+#include "../../parser/operand.h"
+
+namespace reaver
+{
+    namespace assembler
+    {
+        namespace intel
+        {
+            // bitness the form is valid in, operand size it implies and how the register is encoded
+            enum mode : std::uint16_t
+            {
+                bits16 = 1 << 0,
+                bits32 = 1 << 1,
+                bits64 = 1 << 2,
+                mode16 = 1 << 3,
+                mode32 = 1 << 4,
+                rb = 1 << 5,
+                rw = 1 << 6,
+                rd = 1 << 7,
+                ro = 1 << 8,
+                rex = 1 << 9,
+                rexw = 1 << 10,
+                rexr = 1 << 11,
+                all = bits16 | bits32 | bits64
+            };
+
+            struct opcode
+            {
+                const char * mnemonic;
+                // one operand class per slot; slots past operand_count hold `none`
+                std::uint64_t operands[3];
+                std::uint8_t operand_count;
+                std::uint16_t modes;
+                std::uint8_t code[3];
+                std::uint8_t code_size;
+                std::int8_t rm_index;
+                std::int8_t reg_index;
+                bool special_reg;
+            };
+
+            // all forms of a single mnemonic; they are contiguous in the opcode table
+            struct mnemonic
+            {
+                const char * name;
+                std::uint8_t length;
+                std::uint8_t count;
+                std::uint16_t first;
+
+                const opcode * begin() const;
+                const opcode * end() const;
+            };
+
+            // perfect hash lookup; nullptr for anything that isn't a known mnemonic
+            const mnemonic * find_mnemonic(boost::string_ref name);
+        }
+    }
+}
@@ -0,0 +1,121 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include <algorithm>
+
+#include "merge.h"
+#include "../parser/symbol_table.h"
+
+namespace
+{
+    // the offsets at which the entries of the section start, followed by its size
+    std::vector<std::uint64_t> _entries(const reaver::assembler::section & section)
+    {
+        const auto & bytes = section.bytes();
+        auto size = section.entry_size();
+
+        std::vector<std::uint64_t> ret;
+
+        if (!section.strings())
+        {
+            ret.reserve(bytes.size() / size + 1);
+
+            for (std::uint64_t offset = 0; offset < bytes.size(); offset += size)
+            {
+                ret.push_back(offset);
+            }
+        }
+
+        else
+        {
+            std::uint64_t start = 0;
+
+            for (std::uint64_t offset = 0; offset < bytes.size(); offset += size)
+            {
+                if (std::all_of(bytes.begin() + offset, bytes.begin() + offset + size, [](std::uint8_t byte){ return !byte; }))
+                {
+                    ret.push_back(start);
+                    start = offset + size;
+                }
+            }
+        }
+
+        ret.push_back(bytes.size());
+        return ret;
+    }
+}
+
+reaver::assembler::merge_statistics reaver::assembler::merge(reaver::assembler::module & output, std::uint32_t section,
+    const std::vector<std::uint32_t> & defined)
+{
+    auto & target = output.sections()[section];
+    const auto & bytes = target.bytes();
+
+    auto starts = _entries(target);
+
+    merge_statistics ret;
+    ret.entries = starts.size() - 1;
+
+    // the symbol table is only used as a hashed index of the contents of the entries here
+    symbol_table index;
+    std::vector<std::uint64_t> placed;
+    std::vector<std::uint64_t> moved(starts.size());
+
+    std::vector<std::uint8_t> merged;
+    merged.reserve(bytes.size());
+
+    for (std::size_t entry = 0; entry + 1 < starts.size(); ++entry)
+    {
+        auto key = index.intern({ reinterpret_cast<const char *>(bytes.data() + starts[entry]),
+            static_cast<std::size_t>(starts[entry + 1] - starts[entry]) });
+
+        if (key == placed.size())
+        {
+            placed.push_back(merged.size());
+            merged.insert(merged.end(), bytes.begin() + starts[entry], bytes.begin() + starts[entry + 1]);
+        }
+
+        else
+        {
+            ++ret.folded;
+        }
+
+        moved[entry] = placed[key];
+    }
+
+    moved.back() = merged.size();
+
+    if (!ret.folded)
+    {
+        return ret;
+    }
+
+    for (auto index : defined)
+    {
+        auto & symbol = output.symbols()[index];
+        std::size_t entry = std::upper_bound(starts.begin(), starts.end(), symbol.value) - starts.begin() - 1;
+        symbol.value = moved[entry] + (symbol.value - starts[entry]);
+    }
+
+    target.bytes() = std::move(merged);
+    return ret;
+}
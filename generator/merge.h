@@ -20,10 +20,30 @@
  *
  **/
 
-#include "none.h"
+#pragma once
 
-std::unique_ptr<reaver::format::executable::executable> reaver::assembler::none_generator::operator()(
-    const reaver::assembler::ast &) const
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "../output/module.h"
+
+namespace reaver
 {
-    throw exception(logger::crash) << "not implemented yet: " << __PRETTY_FUNCTION__;
+    namespace assembler
+    {
+        struct merge_statistics
+        {
+            std::size_t entries = 0;
+            std::size_t folded = 0;
+        };
+
+        // folds equal entries of a mergeable section into the first of them, so that every distinct constant or string is
+        // only stored once per object, and moves the symbols pointing into the folded entries (of those defined in the
+        // section, given in `defined`) to the kept ones
+        //
+        // the entries are compared by their bytes, so the section must not have any fixups; its size must be a multiple of
+        // its entry size, and its last string, if it holds strings, must be terminated
+        merge_statistics merge(module & output, std::uint32_t section, const std::vector<std::uint32_t> & defined);
+    }
 }
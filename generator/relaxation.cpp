@@ -0,0 +1,222 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include <algorithm>
+
+#include "relaxation.h"
+
+namespace
+{
+    // growth of the branches, as prefix sums; making a branch long shifts everything past it, and the shift at any point
+    // of the section is a prefix sum, so a single branch changing is a logarithmic update, not a walk over the rest of the
+    // section
+    class _shifts
+    {
+    public:
+        _shifts(std::size_t size) : _tree(size + 1)
+        {
+        }
+
+        void add(std::size_t index, std::uint64_t growth)
+        {
+            for (++index; index < _tree.size(); index += index & -index)
+            {
+                _tree[index] += growth;
+            }
+        }
+
+        // the total growth of branches [0, index)
+        std::uint64_t before(std::size_t index) const
+        {
+            std::uint64_t ret = 0;
+
+            for (; index; index -= index & -index)
+            {
+                ret += _tree[index];
+            }
+
+            return ret;
+        }
+
+    private:
+        std::vector<std::uint64_t> _tree;
+    };
+
+    // the number of branches starting before an offset of the unrelaxed section
+    std::size_t _preceding(const std::vector<reaver::assembler::relaxable_branch> & branches, std::uint64_t offset)
+    {
+        return std::lower_bound(branches.begin(), branches.end(), offset, [](const reaver::assembler::relaxable_branch & b,
+            std::uint64_t o){ return b.offset < o; }) - branches.begin();
+    }
+
+    void _write(std::uint8_t * field, std::int64_t value, std::uint8_t size)
+    {
+        for (std::uint8_t i = 0; i < size; ++i)
+        {
+            field[i] = static_cast<std::uint8_t>(static_cast<std::uint64_t>(value) >> (8 * i));
+        }
+    }
+}
+
+reaver::assembler::relaxation_statistics reaver::assembler::relax(reaver::assembler::module & output, std::uint32_t section,
+    const std::vector<std::uint32_t> & defined, const std::vector<reaver::assembler::relaxable_branch> & branches,
+    std::initializer_list<std::reference_wrapper<std::vector<std::uint64_t>>> offsets)
+{
+    relaxation_statistics ret;
+    ret.branches = branches.size();
+
+    if (branches.empty())
+    {
+        return ret;
+    }
+
+    auto & symbols = output.symbols();
+    auto & target = output.sections()[section];
+
+    _shifts shifts{ branches.size() };
+    std::vector<bool> grown(branches.size());
+
+    // the branches still short, with the number of branches preceding their targets
+    std::vector<std::pair<std::size_t, std::size_t>> pending;
+    pending.reserve(branches.size());
+
+    for (std::size_t i = 0; i < branches.size(); ++i)
+    {
+        if (symbols[branches[i].symbol].section != section)
+        {
+            grown[i] = true;
+            shifts.add(i, branches[i].long_size - branches[i].short_size);
+            continue;
+        }
+
+        pending.emplace_back(i, _preceding(branches, symbols[branches[i].symbol].value));
+    }
+
+    auto displacement = [&](std::size_t i, std::size_t preceding_target, std::uint8_t size)
+    {
+        const auto & branch = branches[i];
+        auto destination = symbols[branch.symbol].value + shifts.before(preceding_target) + branch.addend;
+        auto end = branch.offset + shifts.before(i) + size;
+
+        return static_cast<std::int64_t>(destination - end);
+    };
+
+    // a pass that grows nothing is the last one; each of the others grows at least one branch, so there are never more
+    // passes than branches plus one, and in practice there are very few, since growth is applied as soon as it's found
+    bool changed = true;
+
+    while (changed)
+    {
+        changed = false;
+        ++ret.passes;
+
+        auto end = std::remove_if(pending.begin(), pending.end(), [&](const std::pair<std::size_t, std::size_t> & p)
+        {
+            auto value = displacement(p.first, p.second, branches[p.first].short_size);
+
+            if (value >= -128 && value <= 127)
+            {
+                return false;
+            }
+
+            grown[p.first] = true;
+            shifts.add(p.first, branches[p.first].long_size - branches[p.first].short_size);
+            changed = true;
+
+            return true;
+        });
+
+        pending.erase(end, pending.end());
+    }
+
+    // the final layout is written in a single walk over the old buffer
+    auto total = shifts.before(branches.size());
+
+    std::vector<std::uint8_t> bytes;
+    bytes.reserve(target.size() + total);
+
+    std::uint64_t copied = 0;
+    std::vector<fixup> fixups;
+
+    for (std::size_t i = 0; i < branches.size(); ++i)
+    {
+        const auto & branch = branches[i];
+
+        bytes.insert(bytes.end(), target.bytes().begin() + copied, target.bytes().begin() + branch.offset);
+        copied = branch.offset + branch.short_size;
+
+        if (!grown[i])
+        {
+            bytes.insert(bytes.end(), target.bytes().begin() + branch.offset, target.bytes().begin() + copied - 1);
+            bytes.push_back(static_cast<std::uint8_t>(displacement(i, _preceding(branches, symbols[branch.symbol].value),
+                branch.short_size)));
+            continue;
+        }
+
+        ++ret.grown;
+        bytes.insert(bytes.end(), branch.long_code, branch.long_code + branch.long_size);
+
+        auto field = bytes.size() - branch.field_size;
+
+        if (symbols[branch.symbol].section != section)
+        {
+            fixups.push_back({ field, branch.addend - branch.field_size, branch.symbol, branch.field_size,
+                fixup::kinds::branch });
+            continue;
+        }
+
+        // within 16-bit code the long form only has 16 bits of displacement, but wraps around the segment
+        _write(bytes.data() + field, displacement(i, _preceding(branches, symbols[branch.symbol].value), branch.long_size),
+            branch.field_size);
+    }
+
+    bytes.insert(bytes.end(), target.bytes().begin() + copied, target.bytes().end());
+
+    // symbols defined at the very start of a branch stay before it
+    for (auto index : defined)
+    {
+        symbols[index].value += shifts.before(_preceding(branches, symbols[index].value));
+    }
+
+    for (auto & fixup : target.fixups())
+    {
+        fixup.offset += shifts.before(_preceding(branches, fixup.offset));
+    }
+
+    for (auto list : offsets)
+    {
+        for (auto & offset : list.get())
+        {
+            offset += shifts.before(_preceding(branches, offset));
+        }
+    }
+
+    target.fixups().insert(target.fixups().end(), fixups.begin(), fixups.end());
+    std::stable_sort(target.fixups().begin(), target.fixups().end(), [](const fixup & lhs, const fixup & rhs)
+    {
+        return lhs.offset < rhs.offset;
+    });
+
+    target.bytes() = std::move(bytes);
+
+    return ret;
+}
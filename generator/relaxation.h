@@ -0,0 +1,68 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+#include "../output/module.h"
+
+namespace reaver
+{
+    namespace assembler
+    {
+        // a branch with both a short and a long encoding; while the section is generated, only the short one is in its
+        // buffer, with the displacement (always its last byte) left zeroed
+        struct relaxable_branch
+        {
+            std::uint64_t offset;
+            std::int64_t addend;
+            std::uint32_t symbol;
+            std::uint8_t short_size;
+            std::uint8_t long_size;
+            // the displacement is always the last `field_size` bytes of the long encoding, zeroed in `long_code`
+            std::uint8_t field_size;
+            std::uint8_t long_code[15];
+        };
+
+        struct relaxation_statistics
+        {
+            std::size_t branches = 0;
+            std::size_t grown = 0;
+            std::size_t passes = 0;
+        };
+
+        // picks the shortest encoding of every branch of the section (given in order of their offsets) that still reaches
+        // its target, and rewrites the section's buffer, its fixups and the values of its symbols (the indices of those
+        // defined in the section given in `defined`) accordingly; `offsets` are lists of other positions within the section
+        // kept by the caller (like those of call frame directives), moved the same way
+        //
+        // every branch starts short, and is only ever made long, so the process converges; branches to targets outside of
+        // the section are long from the start and get a fixup
+        relaxation_statistics relax(module & output, std::uint32_t section, const std::vector<std::uint32_t> & defined,
+            const std::vector<relaxable_branch> & branches, std::initializer_list<std::reference_wrapper<std::vector<std::uint64_t>>> offsets);
+    }
+}
@@ -27,6 +27,9 @@
 #include "parser/parser.h"
 #include "generator/generator.h"
 #include "output/output.h"
+#include "output/cache.h"
+#include "output/text/text.h"
+#include "utils/stage.h"
 
 using namespace reaver::logger;
 
@@ -35,19 +38,142 @@ int main(int argc, char ** argv) try
     reaver::error_engine engine;
 
     reaver::assembler::console_frontend frontend{ argc, argv, engine };
-    auto preprocessor = reaver::assembler::create_preprocessor(frontend, engine);
-    auto parser = reaver::assembler::create_parser(frontend, engine);
-    auto generator = reaver::assembler::create_generator(frontend, engine);
+
+    // the stages may run on separate threads, so each of them reports to its own engine
+    reaver::error_engine preprocessor_engine;
+    reaver::error_engine parser_engine;
+    reaver::error_engine generator_engine;
+
+    auto preprocessor = reaver::assembler::create_preprocessor(frontend, preprocessor_engine);
+
+    // with -E, the lines go straight from the preprocessor to the output file
+    if (frontend.preprocess_only())
+    {
+        using namespace reaver::assembler;
+
+        text_output text{ frontend, engine };
+        utils::bounded_queue<line> lines{ frontend.pipeline_depth() };
+
+        {
+            utils::stage preprocess{ [&](){ (*preprocessor)(lines); lines.close(); }, lines };
+
+            try
+            {
+                text(lines);
+            }
+
+            catch (utils::queue_aborted &)
+            {
+                // the preprocessor failed; joining it rethrows its error
+            }
+
+            catch (...)
+            {
+                lines.abort();
+                throw;
+            }
+
+            preprocess.join();
+        }
+
+        if (!preprocessor_engine)
+        {
+            throw std::move(preprocessor_engine);
+        }
+
+        text.finish();
+
+        for (auto each : { &preprocessor_engine, &engine })
+        {
+            if (each->size())
+            {
+                each->print(dlog);
+            }
+        }
+
+        return 0;
+    }
+
+    auto parser = reaver::assembler::create_parser(frontend, parser_engine);
+    auto generator = reaver::assembler::create_generator(frontend, generator_engine);
     auto output = reaver::assembler::create_output(frontend, engine);
 
-    auto preprocessed = (*preprocessor)();
-    auto parsed = (*parser)(preprocessed);
-    auto generated = (*generator)(parsed);
-    (*output)(generated);
+    std::unique_ptr<reaver::assembler::module> generated;
+    std::unique_ptr<reaver::assembler::object_cache> cache;
+
+    // only objects are cached; a linked executable depends on more than the source it was assembled from
+    auto cached = !frontend.cache_directory().empty() && (frontend.assemble_only() || frontend.format() == "binary");
+
+    // the object can only be looked up once the whole source is preprocessed, so with a cache the stages aren't pipelined
+    if (!frontend.pipeline_depth() || cached)
+    {
+        auto preprocessed = (*preprocessor)();
+
+        if (cached && preprocessor_engine)
+        {
+            cache = std::make_unique<reaver::assembler::object_cache>(frontend, engine);
+
+            if (cache->fetch(preprocessed))
+            {
+                for (auto each : { &preprocessor_engine, &engine })
+                {
+                    if (each->size())
+                    {
+                        each->print(dlog);
+                    }
+                }
+
+                return 0;
+            }
+        }
+
+        auto parsed = (*parser)(preprocessed);
+        generated = (*generator)(parsed);
+    }
+
+    else
+    {
+        using namespace reaver::assembler;
+
+        utils::bounded_queue<line> lines{ frontend.pipeline_depth() };
+        utils::bounded_queue<ast> fragments{ frontend.pipeline_depth() };
+
+        utils::stage preprocess{ [&](){ (*preprocessor)(lines); lines.close(); }, lines };
+        utils::stage parse{ [&](){ (*parser)(lines, fragments); fragments.close(); }, lines, fragments };
+        utils::stage generate{ [&](){ generated = (*generator)(fragments); }, fragments };
+
+        preprocess.join();
+        parse.join();
+        generate.join();
+    }
+
+    // more than one stage may have something to report when one of them fails, so all of it is printed
+    if (!preprocessor_engine || !parser_engine || !generator_engine)
+    {
+        for (auto each : { &preprocessor_engine, &parser_engine, &generator_engine })
+        {
+            if (each->size())
+            {
+                each->print(dlog);
+            }
+        }
+
+        return 1;
+    }
+
+    (*output)(*generated);
+
+    if (cache)
+    {
+        cache->store();
+    }
 
-    if (engine.size())
+    for (auto each : { &preprocessor_engine, &parser_engine, &generator_engine, &engine })
     {
-        engine.print(dlog);
+        if (each->size())
+        {
+            each->print(dlog);
+        }
     }
 }
 
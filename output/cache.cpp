@@ -0,0 +1,168 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+#include "cache.h"
+#include "../utils/output_file.h"
+
+namespace
+{
+    __extension__ typedef unsigned __int128 _uint128;
+
+    // FNV-1a, 128-bit
+    class _hash
+    {
+    public:
+        void add(boost::string_ref bytes)
+        {
+            for (auto c : bytes)
+            {
+                _value = (_value ^ static_cast<unsigned char>(c)) * _prime;
+            }
+        }
+
+        // a field followed by a separator, so that the boundaries between fields count too
+        void field(boost::string_ref bytes)
+        {
+            add(bytes);
+            add({ "", 1 });
+        }
+
+        std::string hex() const
+        {
+            const char digits[] = "0123456789abcdef";
+            std::string ret(32, '0');
+
+            for (std::size_t i = 0; i < 32; ++i)
+            {
+                ret[31 - i] = digits[static_cast<std::size_t>(_value >> (4 * i)) & 0xf];
+            }
+
+            return ret;
+        }
+
+    private:
+        static constexpr _uint128 _prime = (_uint128{ 1 } << 88) | 0x13b;
+        _uint128 _value = (_uint128{ 0x6c62272e07bb0142 } << 64) | 0x62b821756295c58d;
+    };
+}
+
+reaver::assembler::object_cache::object_cache(const reaver::assembler::frontend & front, reaver::error_engine & engine)
+    : _front{ front }, _engine{ engine }
+{
+    // failing to create it only makes every lookup a miss, and every store a warning
+    boost::system::error_code error;
+    boost::filesystem::create_directories(_front.cache_directory(), error);
+}
+
+bool reaver::assembler::object_cache::fetch(const std::vector<reaver::assembler::line> & preprocessed)
+{
+    _hash hash;
+
+    std::ostringstream target;
+    target << _front.target();
+
+    hash.field(version_string);
+    hash.field(target.str());
+    hash.field(_front.syntax());
+    hash.field(_front.format());
+    hash.field(std::to_string(_front.optimization_level()));
+    hash.field(_front.function_sections() ? "function-sections" : "");
+    hash.field(_front.debug_info() ? "debug" : "");
+    hash.field(std::to_string(static_cast<int>(_front.default_visibility())));
+
+    for (const auto & define : _front.defines())
+    {
+        hash.field(define.first);
+        hash.field(define.second->definition());
+    }
+
+    // with debugging information, where the lines come from ends up in the object too
+    if (_front.debug_info())
+    {
+        hash.field(boost::filesystem::current_path().string());
+    }
+
+    for (const auto & l : preprocessed)
+    {
+        hash.field(l.preprocessed);
+
+        if (_front.debug_info())
+        {
+            hash.field(_front.sources().file_name(l.location));
+            hash.field(std::to_string(_front.sources().line_number(l.location)));
+        }
+    }
+
+    _entry = _front.cache_directory() + "/" + hash.hex() + ".o";
+
+    if (::access(_entry.c_str(), R_OK) != 0)
+    {
+        return false;
+    }
+
+    utils::output_file output{ _front.output_name() };
+
+    if (!output || !output.copy(_entry) || !output.commit())
+    {
+        _engine.push(exception(logger::error) << "failed to write output file `" << _front.output_name() << "`: "
+            << std::strerror(errno) << ".");
+        throw std::move(_engine);
+    }
+
+    if (_front.statistics())
+    {
+        _engine.push(exception(logger::note) << "object cache: hit; copied `" << _entry << "`.");
+    }
+
+    return true;
+}
+
+void reaver::assembler::object_cache::store()
+{
+    // there's nothing to copy the entry from
+    if (_front.output_name() == "-")
+    {
+        return;
+    }
+
+    utils::output_file entry{ _entry };
+
+    if (!entry || !entry.copy(_front.output_name()) || !entry.commit())
+    {
+        _engine.push(exception(logger::warning) << "failed to store `" << _entry << "` in the object cache: "
+            << std::strerror(errno) << ".");
+        return;
+    }
+
+    if (_front.statistics())
+    {
+        _engine.push(exception(logger::note) << "object cache: miss; stored `" << _entry << "`.");
+    }
+}
@@ -0,0 +1,64 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <reaver/error.h>
+
+#include "../frontend/frontend.h"
+#include "../preprocessor/line.h"
+
+namespace reaver
+{
+    namespace assembler
+    {
+        // assembled objects, kept in a directory between runs, so that assembling the same source with the same options again
+        // is reduced to a copy
+        //
+        // an entry is keyed by a 128-bit FNV-1a hash of the preprocessed lines and of everything else that can change the
+        // output: the version of the assembler, the target, the syntax, the format, the optimization level and the defines
+        // (even though their effect is already in the lines, when they are used at all)
+        //
+        // entries are written under temporary names and renamed into place, so concurrent runs sharing the directory only
+        // ever see whole entries
+        class object_cache
+        {
+        public:
+            object_cache(const frontend & front, error_engine & engine);
+
+            // computes the key of the run; if there is an entry for it, copies it to the output and returns true
+            bool fetch(const std::vector<line> & preprocessed);
+
+            // adds the output of the run to the cache
+            void store();
+
+        private:
+            const frontend & _front;
+            error_engine & _engine;
+
+            std::string _entry;
+        };
+    }
+}
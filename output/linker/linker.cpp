@@ -0,0 +1,741 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "linker.h"
+#include "relocatable_object.h"
+#include "../object/elf.h"
+#include "../object/elf_writer.h"
+#include "../object/string_table.h"
+#include "../../parser/symbol_table.h"
+#include "../../utils/output_file.h"
+
+namespace
+{
+    // where the executable is loaded, like ld puts it
+    constexpr std::uint64_t _base = 0x400000;
+    constexpr std::uint64_t _page = 0x1000;
+
+    std::uint64_t _align(std::uint64_t offset, std::uint64_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    // the sections of the executable, in the order they are laid out; up to `_data`, they are in the read-only segment
+    enum _outputs : std::uint32_t
+    {
+        _text,
+        _rodata,
+        _eh_frame,
+        _data,
+        _got,
+        _bss,
+        _output_count
+    };
+
+    const char * const _output_names[] = { ".text", ".rodata", ".eh_frame", ".data", ".got", ".bss" };
+
+    // a section of one of the inputs
+    struct _input
+    {
+        boost::string_ref name;
+        std::uint64_t flags = 0;
+        bool nobits = false;
+        std::uint64_t alignment = 1;
+        const std::uint8_t * data = nullptr;
+        std::uint64_t size = 0;
+        const std::vector<reaver::assembler::fixup> * fixups = nullptr;
+
+        // `_output_count` when the section isn't loaded
+        std::uint32_t output = _output_count;
+        std::uint64_t address = 0;
+        std::uint64_t offset = 0;
+    };
+
+    // a symbol of one of the inputs
+    struct _symbol
+    {
+        boost::string_ref name;
+        std::uint32_t section = reaver::assembler::undefined_section;
+        std::uint64_t value = 0;
+        std::uint64_t size = 0;
+        std::uint8_t binding = reaver::assembler::elf::local_binding;
+        std::uint8_t type = reaver::assembler::elf::no_type;
+        bool defined = false;
+        bool absolute = false;
+        bool common = false;
+    };
+
+    // the assembled module, or one of the objects
+    struct _unit
+    {
+        std::string name;
+        std::vector<_input> sections;
+        std::vector<_symbol> symbols;
+        // of the symbols, once the sections are laid out
+        std::vector<std::uint64_t> addresses;
+    };
+
+    // a section of the executable
+    struct _output
+    {
+        std::uint64_t offset = 0;
+        std::uint64_t address = 0;
+        std::uint64_t size = 0;
+        std::uint64_t alignment = 1;
+    };
+
+    std::uint32_t _classify(const _input & input)
+    {
+        using namespace reaver::assembler::elf;
+
+        if (!(input.flags & allocated))
+        {
+            return _output_count;
+        }
+
+        // whatever has no contents in the file goes after everything that does
+        if (input.nobits)
+        {
+            return _bss;
+        }
+
+        if (input.flags & executable)
+        {
+            return _text;
+        }
+
+        if (input.flags & writable)
+        {
+            return _data;
+        }
+
+        return input.name == ".eh_frame" ? _eh_frame : _rodata;
+    }
+
+    _unit _describe(const reaver::assembler::module & output, const reaver::assembler::frontend & front)
+    {
+        using namespace reaver::assembler;
+
+        _unit ret;
+        ret.name = front.input_name();
+
+        for (const auto & section : output.sections())
+        {
+            elf64::section_header header{};
+            elf::describe(section, header);
+
+            _input input;
+            input.name = section.name();
+            input.flags = header.flags;
+            input.nobits = header.type == elf::nobits;
+            input.alignment = header.alignment;
+            input.data = section.bytes().data();
+            input.size = section.size();
+            input.fixups = &section.fixups();
+
+            ret.sections.push_back(input);
+        }
+
+        for (std::uint32_t i = 0; i < output.symbols().size(); ++i)
+        {
+            const auto & symbol = output.symbols()[i];
+
+            _symbol entry;
+            entry.name = front.symbols().name(i);
+            entry.section = symbol.section;
+            entry.value = symbol.value;
+            entry.size = symbol.size;
+            entry.binding = symbol.binding == symbol::bindings::local ? elf::local_binding : elf::global_binding;
+            entry.type = elf::type_of(symbol.type);
+            entry.defined = symbol.section != undefined_section;
+
+            ret.symbols.push_back(entry);
+        }
+
+        return ret;
+    }
+
+    _unit _describe(const reaver::assembler::relocatable_object & object)
+    {
+        using namespace reaver::assembler;
+
+        _unit ret;
+        ret.name = object.path();
+
+        for (const auto & section : object.sections())
+        {
+            _input input;
+            input.name = section.name;
+            input.flags = section.type == elf::group ? 0 : section.flags;
+            input.nobits = section.type == elf::nobits;
+            input.alignment = section.alignment;
+            input.data = section.data;
+            input.size = section.size;
+            input.fixups = &section.fixups;
+
+            ret.sections.push_back(input);
+        }
+
+        for (const auto & symbol : object.symbols())
+        {
+            _symbol entry;
+            entry.name = symbol.name;
+            entry.value = symbol.value;
+            entry.size = symbol.size;
+            entry.binding = symbol.binding;
+            entry.type = symbol.type;
+            entry.absolute = symbol.section == relocatable_object::absolute_section;
+            entry.common = symbol.section == relocatable_object::common_section;
+            entry.defined = symbol.section != elf::undefined_index && !entry.common;
+
+            if (entry.defined && !entry.absolute)
+            {
+                entry.section = symbol.section;
+            }
+
+            ret.symbols.push_back(entry);
+        }
+
+        return ret;
+    }
+}
+
+void reaver::assembler::linker_output::operator()(const reaver::assembler::module & output) const
+{
+    if (!_engine)
+    {
+        throw std::move(_engine);
+    }
+
+    std::vector<relocatable_object> objects;
+    objects.reserve(_front.objects().size());
+
+    for (const auto & path : _front.objects())
+    {
+        objects.emplace_back(path, _engine);
+    }
+
+    std::vector<_unit> units;
+    units.push_back(_describe(output, _front));
+
+    for (const auto & object : objects)
+    {
+        units.push_back(_describe(object));
+    }
+
+    // global symbols are resolved by name; a weak definition gives way to a strong one
+    symbol_table globals;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> definitions;
+
+    for (std::uint32_t u = 0; u < units.size(); ++u)
+    {
+        for (std::uint32_t s = 0; s < units[u].symbols.size(); ++s)
+        {
+            const auto & symbol = units[u].symbols[s];
+
+            if (symbol.binding == elf::local_binding)
+            {
+                continue;
+            }
+
+            auto index = globals.intern(symbol.name);
+            definitions.resize(globals.size(), { no_symbol, no_symbol });
+
+            if (symbol.common)
+            {
+                _engine.push(exception(logger::error) << "`" << units[u].name << "`: `" << symbol.name.to_string() << "` is a common "
+                    "symbol, which can't be linked; compile it with -fno-common.");
+                continue;
+            }
+
+            if (!symbol.defined)
+            {
+                continue;
+            }
+
+            auto & definition = definitions[index];
+
+            if (definition.first == no_symbol || (units[definition.first].symbols[definition.second].binding == elf::weak_binding
+                && symbol.binding != elf::weak_binding))
+            {
+                definition = { u, s };
+            }
+
+            else if (symbol.binding != elf::weak_binding)
+            {
+                _engine.push(exception(logger::error) << "multiple definitions of `" << symbol.name.to_string() << "`, in `"
+                    << units[definition.first].name << "` and in `" << units[u].name << "`.");
+            }
+        }
+    }
+
+    if (!_engine)
+    {
+        throw std::move(_engine);
+    }
+
+    // the definition a symbol of a unit refers to; `no_symbol` for undefined ones
+    auto resolve = [&](std::uint32_t unit, std::uint32_t symbol) -> std::pair<std::uint32_t, std::uint32_t>
+    {
+        const auto & entry = units[unit].symbols[symbol];
+
+        if (entry.binding == elf::local_binding)
+        {
+            return { unit, entry.defined ? symbol : no_symbol };
+        }
+
+        return definitions[globals.find(entry.name)];
+    };
+
+    // every symbol referred to through the GOT gets an entry, shared by all the references to its definition
+    std::map<std::pair<std::uint32_t, std::uint32_t>, std::uint32_t> got_entries;
+
+    for (std::uint32_t u = 0; u < units.size(); ++u)
+    {
+        for (auto & input : units[u].sections)
+        {
+            input.output = _classify(input);
+
+            if (input.output == _output_count)
+            {
+                continue;
+            }
+
+            if (input.flags & elf::thread_local_storage)
+            {
+                _engine.push(exception(logger::error) << "`" << units[u].name << "`: section `" << input.name.to_string()
+                    << "` is thread local, which isn't supported.");
+                continue;
+            }
+
+            for (const auto & fixup : *input.fixups)
+            {
+                if (fixup.kind == fixup::kinds::got || fixup.kind == fixup::kinds::got_rex)
+                {
+                    auto target = resolve(u, fixup.symbol);
+                    got_entries.emplace(target.second == no_symbol ? std::make_pair(u, fixup.symbol) : target, got_entries.size());
+                }
+            }
+        }
+    }
+
+    if (!_engine)
+    {
+        throw std::move(_engine);
+    }
+
+    std::vector<std::uint64_t> got(got_entries.size());
+
+    // the layout, in the order of writing; the sections are placed so that their addresses and their offsets in the file are
+    // equal modulo the page size, which is what lets the segments be mapped straight from the file
+    std::uint64_t loaded = got.size() * sizeof(std::uint64_t);
+    std::uint64_t alignment = sizeof(std::uint64_t);
+
+    for (const auto & unit : units)
+    {
+        for (const auto & input : unit.sections)
+        {
+            loaded += input.output >= _data && input.output != _output_count ? input.size : 0;
+            alignment = std::max(input.output != _output_count ? input.alignment : 1, alignment);
+        }
+    }
+
+    // the padding between the sections, and before the tables, is written from here
+    std::vector<std::uint8_t> zeros(alignment);
+
+    // the segments are the read-only one, the writable one (only when there's anything to put in it), and the one marking
+    // the stack as not executable
+    elf64::header header;
+    std::vector<elf64::program_header> segments(loaded ? 3 : 2, elf64::program_header{});
+    std::vector<_output> outputs(_output_count);
+    std::vector<iovec> parts;
+
+    header.type = elf::executable_file;
+    header.program_header_offset = sizeof(header);
+    header.program_header_entry_size = sizeof(elf64::program_header);
+
+    std::uint64_t offset = sizeof(header) + segments.size() * sizeof(elf64::program_header);
+    std::uint64_t address = _base + offset;
+
+    parts.push_back({ &header, sizeof(header) });
+    parts.push_back({ segments.data(), segments.size() * sizeof(elf64::program_header) });
+
+    auto place = [&](_output & section, const void * data, std::uint64_t size, std::uint64_t alignment, bool nobits)
+    {
+        auto aligned = _align(address, alignment);
+
+        if (!section.size)
+        {
+            section.address = aligned;
+            section.offset = offset + (aligned - address);
+        }
+
+        section.alignment = std::max(section.alignment, alignment);
+        section.size = aligned + size - section.address;
+
+        if (!nobits)
+        {
+            parts.push_back({ zeros.data(), aligned - address });
+            parts.push_back({ const_cast<void *>(data), size });
+            offset += aligned - address + size;
+        }
+
+        address = aligned + size;
+        return aligned;
+    };
+
+    std::uint64_t code_end = 0;
+
+    for (std::uint32_t o = 0; o < _output_count; ++o)
+    {
+        // the writable segment starts a page further, so that its first page is never shared with the last page of the
+        // read-only one
+        if (o == _data)
+        {
+            code_end = offset;
+            address = _base + _page + offset;
+        }
+
+        for (auto & unit : units)
+        {
+            for (auto & input : unit.sections)
+            {
+                if (input.output == o)
+                {
+                    input.offset = offset + (_align(address, input.alignment) - address);
+                    input.address = place(outputs[o], input.data, input.size, input.alignment, input.nobits);
+                }
+            }
+        }
+
+        if (o == _got && !got.empty())
+        {
+            place(outputs[o], got.data(), got.size() * sizeof(std::uint64_t), sizeof(std::uint64_t), false);
+        }
+    }
+
+    auto & code = segments[0];
+    code.type = elf::loadable_segment;
+    code.flags = elf::readable_segment | elf::executable_segment;
+    code.virtual_address = code.physical_address = _base;
+    code.file_size = code.memory_size = code_end;
+    code.alignment = _page;
+
+    if (loaded)
+    {
+        auto & data = segments[1];
+        data.type = elf::loadable_segment;
+        data.flags = elf::readable_segment | elf::writable_segment;
+        data.offset = code_end;
+        data.virtual_address = data.physical_address = _base + _page + code_end;
+        data.file_size = offset - code_end;
+        data.memory_size = address - data.virtual_address;
+        data.alignment = _page;
+    }
+
+    auto & stack = segments.back();
+    stack.type = elf::gnu_stack_segment;
+    stack.flags = elf::readable_segment | elf::writable_segment;
+    stack.alignment = 16;
+
+    // with everything placed, the symbols get their addresses, and the GOT entries their contents
+    for (auto & unit : units)
+    {
+        unit.addresses.resize(unit.symbols.size());
+
+        for (std::uint32_t s = 0; s < unit.symbols.size(); ++s)
+        {
+            const auto & symbol = unit.symbols[s];
+
+            if (symbol.defined)
+            {
+                unit.addresses[s] = symbol.absolute ? symbol.value : unit.sections[symbol.section].address + symbol.value;
+            }
+        }
+    }
+
+    // undefined weak symbols are 0
+    auto address_of = [&](std::uint32_t unit, std::uint32_t symbol) -> std::uint64_t
+    {
+        auto target = resolve(unit, symbol);
+        return target.second == no_symbol ? 0 : units[target.first].addresses[target.second];
+    };
+
+    for (const auto & entry : got_entries)
+    {
+        got[entry.second] = address_of(entry.first.first, entry.first.second);
+    }
+
+    auto entry = globals.find(_front.entry());
+
+    if (entry == no_symbol || definitions[entry].first == no_symbol)
+    {
+        _engine.push(exception(logger::error) << "entry symbol `" << _front.entry() << "` is not defined.");
+    }
+
+    else
+    {
+        header.entry = units[definitions[entry].first].addresses[definitions[entry].second];
+    }
+
+    // the fixups are resolved into patches of the output file, so that no section ever needs to be copied
+    std::vector<utils::output_file::patch> patches;
+    std::set<std::string> undefined;
+
+    for (std::uint32_t u = 0; u < units.size(); ++u)
+    {
+        for (const auto & input : units[u].sections)
+        {
+            if (input.output == _output_count || input.nobits)
+            {
+                continue;
+            }
+
+            for (const auto & fixup : *input.fixups)
+            {
+                auto value = fixup.addend;
+                std::string name = "<absolute>";
+
+                if (fixup.symbol != no_symbol)
+                {
+                    const auto & symbol = units[u].symbols[fixup.symbol];
+                    auto target = resolve(u, fixup.symbol);
+                    name = symbol.name.to_string();
+
+                    if (target.second == no_symbol && symbol.binding != elf::weak_binding && undefined.insert(name).second)
+                    {
+                        _engine.push(exception(logger::error) << "undefined reference to `" << name << "` in `" << units[u].name
+                            << "`.");
+                    }
+
+                    value += address_of(u, fixup.symbol);
+
+                    if (fixup.kind == fixup::kinds::got || fixup.kind == fixup::kinds::got_rex)
+                    {
+                        auto key = target.second == no_symbol ? std::make_pair(u, fixup.symbol) : target;
+                        value = outputs[_got].address + got_entries[key] * sizeof(std::uint64_t) + fixup.addend;
+                    }
+                }
+
+                else if (fixup.section != undefined_section)
+                {
+                    value += units[u].sections[fixup.section].address;
+                }
+
+                if (fixup.relative())
+                {
+                    value -= input.address + fixup.offset;
+                }
+
+                if (!fixup.fits(value))
+                {
+                    _engine.push(exception(logger::error) << (fixup.relative() ? "relative " : "") << "reference to `" << name
+                        << "` in `" << units[u].name << "` out of range.");
+                }
+
+                patches.push_back({ input.offset + fixup.offset, static_cast<std::uint64_t>(value), fixup.size });
+            }
+        }
+    }
+
+    if (!_engine)
+    {
+        throw std::move(_engine);
+    }
+
+    // the sections and the symbols aren't needed to run the executable, but debuggers and profilers look for them
+    std::vector<std::uint32_t> section_index(_output_count);
+    std::uint32_t count = 1;
+
+    for (std::uint32_t o = 0; o < _output_count; ++o)
+    {
+        section_index[o] = outputs[o].size ? count++ : 0;
+    }
+
+    auto symtab_index = count++;
+    auto strtab_index = count++;
+    auto shstrtab_index = count++;
+
+    string_table strtab;
+    string_table shstrtab;
+
+    std::vector<std::uint32_t> output_key(_output_count);
+
+    for (std::uint32_t o = 0; o < _output_count; ++o)
+    {
+        output_key[o] = section_index[o] ? shstrtab.add(_output_names[o]) : 0;
+    }
+
+    auto symtab_key = shstrtab.add(".symtab");
+    auto strtab_key = shstrtab.add(".strtab");
+    auto shstrtab_key = shstrtab.add(".shstrtab");
+
+    // the local symbols of every unit, then the definitions of the global ones
+    std::vector<elf64::symbol> symtab(1, elf64::symbol{});
+    std::vector<std::uint32_t> symbol_key;
+
+    auto add_symbol = [&](std::uint32_t unit, std::uint32_t symbol, std::uint8_t binding)
+    {
+        const auto & entry = units[unit].symbols[symbol];
+        auto output = entry.defined && !entry.absolute ? units[unit].sections[entry.section].output : _output_count;
+
+        if (!entry.defined || entry.name.empty() || entry.type == elf::section_symbol || entry.type == elf::file_symbol
+            || (!entry.absolute && (output == _output_count || !section_index[output])))
+        {
+            return;
+        }
+
+        elf64::symbol ret{};
+        ret.info = (binding << 4) | entry.type;
+        ret.section_table_index = entry.absolute ? std::uint16_t{ elf::absolute_index } : section_index[output];
+        ret.value = units[unit].addresses[symbol];
+        ret.size = entry.size;
+
+        symtab.push_back(ret);
+        symbol_key.push_back(strtab.add(entry.name));
+    };
+
+    for (std::uint32_t u = 0; u < units.size(); ++u)
+    {
+        for (std::uint32_t s = 0; s < units[u].symbols.size(); ++s)
+        {
+            if (units[u].symbols[s].binding == elf::local_binding)
+            {
+                add_symbol(u, s, elf::local_binding);
+            }
+        }
+    }
+
+    auto first_global = symtab.size();
+
+    for (const auto & definition : definitions)
+    {
+        if (definition.first != no_symbol)
+        {
+            add_symbol(definition.first, definition.second, units[definition.first].symbols[definition.second].binding);
+        }
+    }
+
+    strtab.finish();
+    shstrtab.finish();
+
+    for (std::size_t i = 1; i < symtab.size(); ++i)
+    {
+        symtab[i].name = strtab.offset(symbol_key[i - 1]);
+    }
+
+    std::vector<elf64::section_header> section_headers(count, elf64::section_header{});
+
+    for (std::uint32_t o = 0; o < _output_count; ++o)
+    {
+        if (!section_index[o])
+        {
+            continue;
+        }
+
+        auto & section_header = section_headers[section_index[o]];
+        section_header.name = shstrtab.offset(output_key[o]);
+        section_header.type = o == _bss ? elf::nobits : elf::progbits;
+        section_header.flags = elf::allocated;
+
+        if (o == _text || o >= _data)
+        {
+            section_header.flags |= o == _text ? elf::executable : elf::writable;
+        }
+
+        section_header.virtual_address = outputs[o].address;
+        section_header.offset = o == _bss ? offset : outputs[o].offset;
+        section_header.size = outputs[o].size;
+        section_header.alignment = outputs[o].alignment;
+        section_header.entries_size = o == _got ? sizeof(std::uint64_t) : 0;
+    }
+
+    auto place_table = [&](std::uint32_t index, const void * data, std::uint64_t size, std::uint64_t alignment)
+    {
+        auto aligned = _align(offset, alignment);
+        parts.push_back({ zeros.data(), aligned - offset });
+        parts.push_back({ const_cast<void *>(data), size });
+
+        section_headers[index].offset = aligned;
+        section_headers[index].size = size;
+        section_headers[index].alignment = alignment;
+
+        offset = aligned + size;
+    };
+
+    section_headers[symtab_index].name = shstrtab.offset(symtab_key);
+    section_headers[symtab_index].type = elf::symtab;
+    section_headers[symtab_index].link = strtab_index;
+    section_headers[symtab_index].info = first_global;
+    section_headers[symtab_index].entries_size = sizeof(elf64::symbol);
+    place_table(symtab_index, symtab.data(), symtab.size() * sizeof(elf64::symbol), 8);
+
+    section_headers[strtab_index].name = shstrtab.offset(strtab_key);
+    section_headers[strtab_index].type = elf::strtab;
+    place_table(strtab_index, strtab.data().data(), strtab.data().size(), 1);
+
+    section_headers[shstrtab_index].name = shstrtab.offset(shstrtab_key);
+    section_headers[shstrtab_index].type = elf::strtab;
+    place_table(shstrtab_index, shstrtab.data().data(), shstrtab.data().size(), 1);
+
+    header.program_header_entry_count = segments.size();
+    header.section_header_offset = _align(offset, 8);
+    header.section_header_entry_count = count;
+    header.section_name_table_index = shstrtab_index;
+
+    parts.push_back({ zeros.data(), header.section_header_offset - offset });
+    parts.push_back({ section_headers.data(), section_headers.size() * sizeof(elf64::section_header) });
+
+    auto size = header.section_header_offset + section_headers.size() * sizeof(elf64::section_header);
+
+    if (_front.statistics())
+    {
+        std::uint64_t sections = 0;
+
+        for (const auto & unit : units)
+        {
+            for (const auto & input : unit.sections)
+            {
+                sections += input.output != _output_count;
+            }
+        }
+
+        _engine.push(exception(logger::note) << "linker: linked " << units.size() << " input(s) with " << sections
+            << " loaded section(s) into " << size << " bytes; " << patches.size() << " fixup(s) resolved, " << got.size()
+            << " GOT entr" << (got.size() == 1 ? "y" : "ies") << ".");
+    }
+
+    utils::output_file file{ _front.output_name() };
+
+    if (!file || !file.preallocate(size) || !file.write(std::move(parts), std::move(patches), _front.jobs()) || !file.commit(true))
+    {
+        _engine.push(exception(logger::error) << "failed to write output file `" << _front.output_name() << "`: "
+            << std::strerror(errno) << ".");
+        throw std::move(_engine);
+    }
+}
@@ -0,0 +1,56 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include "../output.h"
+
+namespace reaver
+{
+    namespace assembler
+    {
+        // links the assembled module, along with the ELF64 relocatable objects given on the command line, into a static
+        // ELF64 executable, without an intermediate object file
+        //
+        // the loaded sections of all the inputs are gathered into `.text`, `.rodata` and `.eh_frame` in a read-only,
+        // executable segment, and into `.data`, a `.got` for the GOT references and `.bss` in a writable one; the output is
+        // then written straight from the section buffers of the module and from the mappings of the objects, with the
+        // resolved fixups patched into it, the same way flat binaries are written
+        //
+        // there are no archives, shared libraries, COMMON symbols or thread local storage; debugging sections are dropped
+        class linker_output : public output
+        {
+        public:
+            linker_output(const frontend & front, error_engine & engine) : _front{ front }, _engine{ engine }
+            {
+            }
+
+            virtual ~linker_output() {}
+
+            virtual void operator()(const module &) const override;
+
+        private:
+            const frontend & _front;
+            error_engine & _engine;
+        };
+    }
+}
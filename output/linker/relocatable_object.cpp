@@ -0,0 +1,360 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include <cerrno>
+#include <cstring>
+
+#include "relocatable_object.h"
+#include "../object/elf.h"
+
+namespace
+{
+    // the fields of the file aren't necessarily aligned, so they are copied out of it
+    template<typename T>
+    bool _read(boost::string_ref contents, std::uint64_t offset, T & ret)
+    {
+        if (offset > contents.size() || contents.size() - offset < sizeof(T))
+        {
+            return false;
+        }
+
+        std::memcpy(&ret, contents.data() + offset, sizeof(T));
+        return true;
+    }
+
+    boost::string_ref _string(boost::string_ref table, std::uint64_t offset)
+    {
+        if (offset >= table.size())
+        {
+            return {};
+        }
+
+        auto name = table.substr(offset);
+        return name.substr(0, std::min(name.find('\0'), name.size()));
+    }
+
+    // the fixup a relocation stands for; false for the kinds of relocations that aren't supported
+    bool _fixup(std::uint32_t type, reaver::assembler::fixup & ret)
+    {
+        using namespace reaver::assembler::elf;
+        using kinds = reaver::assembler::fixup::kinds;
+
+        switch (type)
+        {
+            case r_x86_64_64:
+                ret.size = 8;
+                ret.kind = kinds::absolute;
+                return true;
+
+            case r_x86_64_pc32:
+                ret.size = 4;
+                ret.kind = kinds::relative;
+                return true;
+
+            case r_x86_64_plt32:
+                ret.size = 4;
+                ret.kind = kinds::branch;
+                return true;
+
+            case r_x86_64_gotpcrel:
+            case r_x86_64_gotpcrelx:
+                ret.size = 4;
+                ret.kind = kinds::got;
+                return true;
+
+            case r_x86_64_rex_gotpcrelx:
+                ret.size = 4;
+                ret.kind = kinds::got_rex;
+                return true;
+
+            case r_x86_64_32:
+                ret.size = 4;
+                ret.kind = kinds::absolute;
+                return true;
+
+            case r_x86_64_32s:
+                ret.size = 4;
+                ret.kind = kinds::absolute_signed;
+                return true;
+
+            case r_x86_64_16:
+                ret.size = 2;
+                ret.kind = kinds::absolute;
+                return true;
+
+            case r_x86_64_pc16:
+                ret.size = 2;
+                ret.kind = kinds::relative;
+                return true;
+
+            case r_x86_64_8:
+                ret.size = 1;
+                ret.kind = kinds::absolute;
+                return true;
+
+            case r_x86_64_pc8:
+                ret.size = 1;
+                ret.kind = kinds::relative;
+                return true;
+
+            case r_x86_64_pc64:
+                ret.size = 8;
+                ret.kind = kinds::relative;
+                return true;
+
+            default:
+                return false;
+        }
+    }
+}
+
+reaver::assembler::relocatable_object::relocatable_object(std::string path, reaver::error_engine & engine) : _path{ std::move(path) },
+    _engine{ engine }, _file{ _path }
+{
+    if (!_file)
+    {
+        _engine.push(exception(logger::error) << "failed to open object `" << _path << "`: " << std::strerror(errno) << ".");
+        throw std::move(_engine);
+    }
+
+    auto contents = _file.contents();
+
+    elf64::header header;
+    const elf64::header expected{};
+
+    if (!_read(contents, 0, header) || std::memcmp(header.ident, expected.ident, 7) != 0)
+    {
+        _fail("not an ELF64 little endian file");
+    }
+
+    if (header.type != elf::relocatable_file || header.machine != expected.machine)
+    {
+        _fail("not an x86_64 relocatable object");
+    }
+
+    if (header.section_header_entry_size != sizeof(elf64::section_header))
+    {
+        _fail("malformed section header table");
+    }
+
+    // with extended numbering, the real number of sections and the index of their names are in the first section header
+    std::uint64_t count = header.section_header_entry_count;
+    std::uint32_t names_index = header.section_name_table_index;
+
+    if (!count || names_index == elf::extended_index)
+    {
+        elf64::section_header first;
+
+        if (header.section_header_offset && !_read(contents, header.section_header_offset, first))
+        {
+            _fail("section headers past the end of the file");
+        }
+
+        count = count || !header.section_header_offset ? count : first.size;
+        names_index = names_index == elf::extended_index ? first.link : names_index;
+    }
+
+    if (names_index >= count || count > contents.size() / sizeof(elf64::section_header))
+    {
+        _fail("malformed section header table");
+    }
+
+    std::vector<elf64::section_header> headers(count);
+
+    for (std::uint32_t i = 0; i < headers.size(); ++i)
+    {
+        if (!_read(contents, header.section_header_offset + i * sizeof(elf64::section_header), headers[i]))
+        {
+            _fail("section headers past the end of the file");
+        }
+    }
+
+    auto bytes = [&](std::uint32_t index)
+    {
+        const auto & section_header = headers[index];
+
+        if (section_header.offset > contents.size() || contents.size() - section_header.offset < section_header.size)
+        {
+            _fail("contents of a section past the end of the file");
+        }
+
+        return contents.substr(section_header.offset, section_header.size);
+    };
+
+    auto names = bytes(names_index);
+    std::uint32_t symtab_index = 0;
+    std::uint32_t indices_index = 0;
+
+    _sections.resize(headers.size());
+
+    for (std::uint32_t i = 0; i < headers.size(); ++i)
+    {
+        auto & section = _sections[i];
+        section.name = _string(names, headers[i].name);
+        section.type = headers[i].type;
+        section.flags = headers[i].flags;
+        section.alignment = std::max<std::uint64_t>(headers[i].alignment, 1);
+        section.size = headers[i].size;
+
+        if (section.type != elf::nobits && section.type != elf::unused)
+        {
+            section.data = reinterpret_cast<const std::uint8_t *>(bytes(i).data());
+        }
+
+        if (section.type == elf::symtab)
+        {
+            if (symtab_index)
+            {
+                _fail("more than one symbol table");
+            }
+
+            symtab_index = i;
+        }
+
+        if (section.type == elf::symtab_indices)
+        {
+            indices_index = i;
+        }
+    }
+
+    if (symtab_index)
+    {
+        const auto & symtab = headers[symtab_index];
+
+        if (symtab.entries_size != sizeof(elf64::symbol) || symtab.link >= headers.size())
+        {
+            _fail("malformed symbol table");
+        }
+
+        auto table = bytes(symtab_index);
+        auto strings = bytes(symtab.link);
+
+        if (indices_index && headers[indices_index].link != symtab_index)
+        {
+            _fail("extended section indices of another symbol table");
+        }
+
+        auto indices = indices_index ? bytes(indices_index) : boost::string_ref{};
+
+        _symbols.resize(table.size() / sizeof(elf64::symbol));
+
+        for (std::uint32_t i = 0; i < _symbols.size(); ++i)
+        {
+            elf64::symbol entry;
+            _read(table, i * sizeof(elf64::symbol), entry);
+
+            std::uint32_t section = entry.section_table_index;
+
+            if (section == elf::extended_index)
+            {
+                if (!_read(indices, i * sizeof(std::uint32_t), section))
+                {
+                    _fail("symbol without an extended section index");
+                }
+            }
+
+            else if (section == elf::absolute_index || section == elf::common_index)
+            {
+                section = section == elf::absolute_index ? absolute_section : common_section;
+            }
+
+            else if (section >= elf::reserved_index)
+            {
+                _fail("symbol in an unsupported special section");
+            }
+
+            if (section >= headers.size() && section != absolute_section && section != common_section)
+            {
+                _fail("symbol in an invalid section");
+            }
+
+            _symbols[i] = { _string(strings, entry.name), static_cast<std::uint8_t>(entry.info >> 4),
+                static_cast<std::uint8_t>(entry.info & 0xf), static_cast<std::uint8_t>(entry.other & 0x3),
+                section, entry.value, entry.size };
+        }
+    }
+
+    for (std::uint32_t i = 0; i < headers.size(); ++i)
+    {
+        if (headers[i].type == elf::rel)
+        {
+            _fail("relocations without addends, which x86_64 doesn't use");
+        }
+
+        if (headers[i].type != elf::rela)
+        {
+            continue;
+        }
+
+        if (headers[i].link != symtab_index || !symtab_index || headers[i].info >= headers.size()
+            || headers[i].entries_size != sizeof(elf64::relocation_addend))
+        {
+            _fail("malformed relocation section `" + _sections[i].name.to_string() + "`");
+        }
+
+        // only what is loaded is relocated; debugging information is left out of the executable
+        auto & target = _sections[headers[i].info];
+
+        if (!(target.flags & elf::allocated))
+        {
+            continue;
+        }
+
+        auto table = bytes(i);
+        target.fixups.reserve(table.size() / sizeof(elf64::relocation_addend));
+
+        for (std::uint64_t offset = 0; offset + sizeof(elf64::relocation_addend) <= table.size();
+            offset += sizeof(elf64::relocation_addend))
+        {
+            elf64::relocation_addend relocation;
+            _read(table, offset, relocation);
+
+            auto type = static_cast<std::uint32_t>(relocation.info);
+
+            if (!type)
+            {
+                continue;
+            }
+
+            fixup fixup{ relocation.offset, relocation.addend, static_cast<std::uint32_t>(relocation.info >> 32), 0,
+                fixup::kinds::absolute };
+
+            if (!_fixup(type, fixup))
+            {
+                _fail("unsupported relocation type " + std::to_string(type) + " in `" + target.name.to_string() + "`");
+            }
+
+            if (fixup.symbol >= _symbols.size() || fixup.offset > target.size || target.size - fixup.offset < fixup.size)
+            {
+                _fail("malformed relocation in `" + target.name.to_string() + "`");
+            }
+
+            target.fixups.push_back(fixup);
+        }
+    }
+}
+
+void reaver::assembler::relocatable_object::_fail(std::string message)
+{
+    _engine.push(exception(logger::error) << "`" << _path << "`: " << message << ".");
+    throw std::move(_engine);
+}
@@ -0,0 +1,110 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/utility/string_ref.hpp>
+
+#include <reaver/error.h>
+
+#include "../section.h"
+#include "../../utils/mapped_file.h"
+
+namespace reaver
+{
+    namespace assembler
+    {
+        // an ELF64 (x86_64) relocatable object to be linked, read in place from its mapping
+        //
+        // the relocations are turned into fixups of the same kinds the generator produces, against the symbols of the
+        // object (section symbols included), so that the linker can resolve them the same way it resolves those of the
+        // assembled module
+        class relocatable_object
+        {
+        public:
+            struct section
+            {
+                boost::string_ref name;
+                std::uint32_t type = 0;
+                std::uint64_t flags = 0;
+                std::uint64_t alignment = 1;
+                const std::uint8_t * data = nullptr;
+                std::uint64_t size = 0;
+                std::vector<fixup> fixups;
+            };
+
+            // with extended numbering, an object can have real sections at the special indices, so those of symbols are
+            // moved out of the way
+            static constexpr std::uint32_t absolute_section = 0xfffffff1;
+            static constexpr std::uint32_t common_section = 0xfffffff2;
+
+            struct symbol
+            {
+                boost::string_ref name;
+                std::uint8_t binding;
+                std::uint8_t type;
+                std::uint8_t visibility;
+                // the ELF section index (0 when undefined), with extended indices looked up, or one of the special sections
+                // above
+                std::uint32_t section;
+                std::uint64_t value;
+                std::uint64_t size;
+            };
+
+            // reports a malformed or unsupported object to the engine, and throws it
+            relocatable_object(std::string path, error_engine & engine);
+
+            relocatable_object(relocatable_object &&) = default;
+
+            const std::string & path() const
+            {
+                return _path;
+            }
+
+            // indexed like the section headers of the file
+            const std::vector<section> & sections() const
+            {
+                return _sections;
+            }
+
+            // indexed like the symbol table of the file
+            const std::vector<symbol> & symbols() const
+            {
+                return _symbols;
+            }
+
+        private:
+            void _fail(std::string message);
+
+            std::string _path;
+            error_engine & _engine;
+            utils::mapped_file _file;
+
+            std::vector<section> _sections;
+            std::vector<symbol> _symbols;
+        };
+    }
+}
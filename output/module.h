@@ -0,0 +1,113 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/utility/string_ref.hpp>
+
+#include "section.h"
+#include "../parser/symbol_table.h"
+
+namespace reaver
+{
+    namespace assembler
+    {
+        // what the generator knows about a symbol; the name is kept in the frontend's symbol table, under the same index
+        struct symbol
+        {
+            enum class bindings : std::uint8_t
+            {
+                local,
+                global,
+                external
+            };
+
+            std::uint64_t value = 0;
+            std::uint32_t section = undefined_section;
+            bindings binding = bindings::local;
+            symbol_types type = symbol_types::none;
+            symbol_visibilities visibility = symbol_visibilities::default_visibility;
+            // the number of bytes the symbol spans; 0 when unknown
+            std::uint64_t size = 0;
+        };
+
+        // everything the generator produces for a single translation unit; sections are referred to by their indices, and
+        // symbols by their indices in the symbol table
+        class module
+        {
+        public:
+            std::vector<section> & sections()
+            {
+                return _sections;
+            }
+
+            const std::vector<section> & sections() const
+            {
+                return _sections;
+            }
+
+            std::vector<symbol> & symbols()
+            {
+                return _symbols;
+            }
+
+            const std::vector<symbol> & symbols() const
+            {
+                return _symbols;
+            }
+
+            // the address the output is loaded at, as given by `org`; only flat binaries are placed by the assembler itself
+            std::uint64_t origin() const
+            {
+                return _origin;
+            }
+
+            void origin(std::uint64_t address)
+            {
+                _origin = address;
+            }
+
+            // returns the index of the section, creating it if it doesn't exist yet; sections must only be created here
+            std::uint32_t section_index(boost::string_ref name)
+            {
+                auto index = _section_names.intern(name);
+
+                if (index == _sections.size())
+                {
+                    _sections.emplace_back(name);
+                }
+
+                return index;
+            }
+
+        private:
+            std::vector<section> _sections;
+            // the symbol table is only used as a hashed index of the section names here, in the order of the sections
+            symbol_table _section_names;
+            std::vector<symbol> _symbols;
+            std::uint64_t _origin = 0;
+        };
+    }
+}
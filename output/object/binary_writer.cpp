@@ -0,0 +1,144 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "binary_writer.h"
+#include "../../parser/symbol_table.h"
+#include "../../utils/output_file.h"
+
+namespace
+{
+    const std::uint8_t _zeros[4] = {};
+
+    // like nasm does in its flat output
+    constexpr std::uint64_t _section_alignment = 4;
+
+    std::uint64_t _align(std::uint64_t offset, std::uint64_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+}
+
+void reaver::assembler::binary_writer::operator()(const reaver::assembler::module & output) const
+{
+    const auto & sections = output.sections();
+    const auto & symbols = output.symbols();
+
+    // the initialized sections first, in their order, then the uninitialized ones
+    std::vector<std::uint64_t> offsets(sections.size());
+    std::uint64_t size = 0;
+
+    for (bool uninitialized : { false, true })
+    {
+        for (std::uint32_t i = 0; i < sections.size(); ++i)
+        {
+            if (sections[i].uninitialized() == uninitialized)
+            {
+                offsets[i] = size = _align(size, _section_alignment);
+                size += sections[i].size();
+            }
+        }
+    }
+
+    // the fixups are resolved into patches of the output file, so that the sections themselves never need to be copied
+    std::vector<utils::output_file::patch> patches;
+
+    for (std::uint32_t i = 0; i < sections.size(); ++i)
+    {
+        for (const auto & fixup : sections[i].fixups())
+        {
+            auto value = fixup.addend;
+
+            if (fixup.kind == fixup::kinds::got || fixup.kind == fixup::kinds::got_rex)
+            {
+                _engine.push(exception(logger::error) << "reference to the GOT entry of `" << _front.symbols().name(fixup.symbol)
+                    .to_string() << "`; flat binaries don't have a GOT.");
+                continue;
+            }
+
+            if (fixup.symbol != no_symbol)
+            {
+                const auto & symbol = symbols[fixup.symbol];
+
+                if (symbol.section == undefined_section)
+                {
+                    _engine.push(exception(logger::error) << "symbol `" << _front.symbols().name(fixup.symbol).to_string()
+                        << "` is external; flat binaries can't refer to other objects.");
+                    continue;
+                }
+
+                value += output.origin() + offsets[symbol.section] + symbol.value;
+            }
+
+            else if (fixup.section != undefined_section)
+            {
+                value += output.origin() + offsets[fixup.section];
+            }
+
+            if (fixup.relative())
+            {
+                value -= output.origin() + offsets[i] + fixup.offset;
+            }
+
+            if (!fixup.fits(value))
+            {
+                _engine.push(exception(logger::error) << (fixup.relative() ? "relative " : "") << "reference to `"
+                    << (fixup.symbol == no_symbol ? std::string{ "<absolute>" } : _front.symbols().name(fixup.symbol).to_string())
+                    << "` out of range.");
+            }
+
+            patches.push_back({ offsets[i] + fixup.offset, static_cast<std::uint64_t>(value), fixup.size });
+        }
+    }
+
+    if (!_engine)
+    {
+        throw std::move(_engine);
+    }
+
+    std::vector<iovec> parts;
+    std::uint64_t offset = 0;
+
+    for (std::uint32_t i = 0; i < sections.size(); ++i)
+    {
+        if (sections[i].uninitialized() || !sections[i].size())
+        {
+            continue;
+        }
+
+        parts.push_back({ const_cast<std::uint8_t *>(_zeros), offsets[i] - offset });
+        parts.push_back({ const_cast<std::uint8_t *>(sections[i].bytes().data()), sections[i].size() });
+        offset = offsets[i] + sections[i].size();
+    }
+
+    utils::output_file file{ _front.output_name() };
+
+    if (!file || !file.preallocate(offset) || !file.write(std::move(parts), std::move(patches), _front.jobs()) || !file.commit())
+    {
+        _engine.push(exception(logger::error) << "failed to write output file `" << _front.output_name() << "`: "
+            << std::strerror(errno) << ".");
+        throw std::move(_engine);
+    }
+}
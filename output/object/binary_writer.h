@@ -1,7 +1,7 @@
 /**
  * Reaver Project Assembler License
  *
- * Copyright © 2013-2014 Michał "Griwes" Dominiak
+ * Copyright © 2014 Michał "Griwes" Dominiak
  *
  * This software is provided 'as-is', without any express or implied
  * warranty. In no event will the authors be held liable for any damages
@@ -22,22 +22,32 @@
 
 #pragma once
 
-#include "../parser.h"
+#include <reaver/error.h>
+
+#include "../../frontend/frontend.h"
+#include "../module.h"
 
 namespace reaver
 {
     namespace assembler
     {
-        class none_parser : public parser
+        // writes a flat binary: the sections are concatenated in their order, with the sections without contents (like
+        // `.bss`) placed after the end of the file, and every address is counted from the origin given by `org`
+        //
+        // there's nothing to relocate at load time, so all fixups are resolved here, and patched into the output file as it
+        // is written; the sections themselves are written straight from their buffers
+        class binary_writer
         {
         public:
-            none_parser()
+            binary_writer(const frontend & front, error_engine & engine) : _front{ front }, _engine{ engine }
             {
             }
 
-            virtual ~none_parser() {}
+            void operator()(const module &) const;
 
-            virtual ast operator()(const std::vector<line> &) const override;
+        private:
+            const frontend & _front;
+            error_engine & _engine;
         };
     }
 }
@@ -0,0 +1,261 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <cstdint>
+
+namespace reaver
+{
+    namespace assembler
+    {
+        namespace elf
+        {
+            enum section_types : std::uint32_t
+            {
+                unused = 0,
+                progbits = 1,
+                symtab = 2,
+                strtab = 3,
+                rela = 4,
+                nobits = 8,
+                rel = 9,
+                group = 17,
+                symtab_indices = 18
+            };
+
+            enum section_flags : std::uint64_t
+            {
+                writable = 0x1,
+                allocated = 0x2,
+                executable = 0x4,
+                mergeable = 0x10,
+                strings = 0x20,
+                thread_local_storage = 0x400
+            };
+
+            // special section indices of symbols; indices from `reserved_index` on don't fit in the 16-bit fields, so the real
+            // ones are kept elsewhere (in the first section header, and in the `symtab_indices` section for symbols), with
+            // `extended_index` in their place
+            enum symbol_sections : std::uint16_t
+            {
+                undefined_index = 0,
+                reserved_index = 0xff00,
+                absolute_index = 0xfff1,
+                common_index = 0xfff2,
+                extended_index = 0xffff
+            };
+
+            enum symbol_bindings : std::uint8_t
+            {
+                local_binding = 0,
+                global_binding = 1,
+                weak_binding = 2
+            };
+
+            enum symbol_types : std::uint8_t
+            {
+                no_type = 0,
+                object_symbol = 1,
+                function_symbol = 2,
+                section_symbol = 3,
+                file_symbol = 4
+            };
+
+            enum file_types : std::uint16_t
+            {
+                relocatable_file = 1,
+                executable_file = 2
+            };
+
+            enum segment_types : std::uint32_t
+            {
+                loadable_segment = 1,
+                gnu_stack_segment = 0x6474e551
+            };
+
+            enum segment_flags : std::uint32_t
+            {
+                executable_segment = 0x1,
+                writable_segment = 0x2,
+                readable_segment = 0x4
+            };
+
+            // x86_64 relocation types
+            enum relocation_types : std::uint32_t
+            {
+                r_x86_64_64 = 1,
+                r_x86_64_pc32 = 2,
+                r_x86_64_plt32 = 4,
+                r_x86_64_gotpcrel = 9,
+                r_x86_64_32 = 10,
+                r_x86_64_32s = 11,
+                r_x86_64_16 = 12,
+                r_x86_64_pc16 = 13,
+                r_x86_64_8 = 14,
+                r_x86_64_pc8 = 15,
+                r_x86_64_pc64 = 24,
+                r_x86_64_gotpcrelx = 41,
+                r_x86_64_rex_gotpcrelx = 42
+            };
+
+            // i386 relocation types
+            enum i386_relocation_types : std::uint32_t
+            {
+                r_386_32 = 1,
+                r_386_pc32 = 2,
+                r_386_16 = 20,
+                r_386_pc16 = 21,
+                r_386_8 = 22,
+                r_386_pc8 = 23
+            };
+        }
+
+        namespace elf32
+        {
+            struct header
+            {
+                std::uint8_t ident[16] = { 0x7f, 'E', 'L', 'F', 1, 1, 1, 0, 0 };
+                std::uint16_t type = 1;
+                std::uint16_t machine = 3;
+                std::uint32_t version = 1;
+                std::uint32_t entry = 0;
+                std::uint32_t program_header_offset = 0;
+                std::uint32_t section_header_offset = 0;
+                std::uint32_t flags = 0;
+                std::uint16_t header_size = 52;
+                std::uint16_t program_header_entry_size = 0;
+                std::uint16_t program_header_entry_count = 0;
+                std::uint16_t section_header_entry_size = 40;
+                std::uint16_t section_header_entry_count = 0;
+                std::uint16_t section_name_table_index = 0;
+            };
+
+            struct section_header
+            {
+                std::uint32_t name;
+                std::uint32_t type;
+                std::uint32_t flags;
+                std::uint32_t virtual_address;
+                std::uint32_t offset;
+                std::uint32_t size;
+                std::uint32_t link;
+                std::uint32_t info;
+                std::uint32_t alignment;
+                std::uint32_t entries_size;
+            };
+
+            struct symbol
+            {
+                std::uint32_t name;
+                std::uint32_t value;
+                std::uint32_t size;
+                std::uint8_t info;
+                std::uint8_t other;
+                std::uint16_t section_table_index;
+            };
+
+            // i386 objects carry the addends in the fields being relocated
+            struct relocation
+            {
+                std::uint32_t offset;
+                std::uint32_t info;
+            };
+
+            static_assert(sizeof(header) == 52, "invalid layout of the ELF32 header");
+            static_assert(sizeof(section_header) == 40, "invalid layout of the ELF32 section header");
+            static_assert(sizeof(symbol) == 16, "invalid layout of the ELF32 symbol");
+            static_assert(sizeof(relocation) == 8, "invalid layout of the ELF32 relocation");
+        }
+
+        namespace elf64
+        {
+            struct header
+            {
+                std::uint8_t ident[16] = { 0x7f, 'E', 'L', 'F', 2, 1, 1, 0, 0 };
+                std::uint16_t type = 1;
+                std::uint16_t machine = 62;
+                std::uint32_t version = 1;
+                std::uint64_t entry = 0;
+                std::uint64_t program_header_offset = 0;
+                std::uint64_t section_header_offset = 0;
+                std::uint32_t flags = 0;
+                std::uint16_t header_size = 64;
+                std::uint16_t program_header_entry_size = 0;
+                std::uint16_t program_header_entry_count = 0;
+                std::uint16_t section_header_entry_size = 64;
+                std::uint16_t section_header_entry_count = 0;
+                std::uint16_t section_name_table_index = 0;
+            };
+
+            struct section_header
+            {
+                std::uint32_t name;
+                std::uint32_t type;
+                std::uint64_t flags;
+                std::uint64_t virtual_address;
+                std::uint64_t offset;
+                std::uint64_t size;
+                std::uint32_t link;
+                std::uint32_t info;
+                std::uint64_t alignment;
+                std::uint64_t entries_size;
+            };
+
+            struct symbol
+            {
+                std::uint32_t name;
+                std::uint8_t info;
+                std::uint8_t other;
+                std::uint16_t section_table_index;
+                std::uint64_t value;
+                std::uint64_t size;
+            };
+
+            struct relocation_addend
+            {
+                std::uint64_t offset;
+                std::uint64_t info;
+                std::int64_t addend;
+            };
+
+            struct program_header
+            {
+                std::uint32_t type;
+                std::uint32_t flags;
+                std::uint64_t offset;
+                std::uint64_t virtual_address;
+                std::uint64_t physical_address;
+                std::uint64_t file_size;
+                std::uint64_t memory_size;
+                std::uint64_t alignment;
+            };
+
+            // the structures are written to the file as they are in memory
+            static_assert(sizeof(header) == 64, "invalid layout of the ELF64 header");
+            static_assert(sizeof(section_header) == 64, "invalid layout of the ELF64 section header");
+            static_assert(sizeof(symbol) == 24, "invalid layout of the ELF64 symbol");
+            static_assert(sizeof(relocation_addend) == 24, "invalid layout of the ELF64 relocation");
+            static_assert(sizeof(program_header) == 56, "invalid layout of the ELF64 program header");
+        }
+    }
+}
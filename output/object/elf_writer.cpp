@@ -0,0 +1,443 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "elf_writer.h"
+#include "elf.h"
+#include "string_table.h"
+#include "../../parser/symbol_table.h"
+#include "../../utils/output_file.h"
+
+namespace
+{
+    const std::uint8_t _zeros[16] = {};
+
+    std::uint64_t _align(std::uint64_t offset, std::uint64_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+}
+
+// the parts of the layout that differ between the classes of ELF files
+struct reaver::assembler::elf32::format
+{
+    using header = elf32::header;
+    using section_header = elf32::section_header;
+    using symbol = elf32::symbol;
+    using relocation = elf32::relocation;
+
+    static constexpr std::uint32_t relocation_section = elf::rel;
+    static constexpr std::uint64_t table_alignment = 4;
+    static constexpr bool implicit_addends = true;
+
+    static const char * relocation_prefix()
+    {
+        return ".rel";
+    }
+
+    // returns false when the field can't be described in this class of files
+    static bool relocate(const reaver::assembler::fixup & fixup, std::uint32_t symbol, std::int64_t, relocation & ret)
+    {
+        using namespace reaver::assembler::elf;
+
+        // GOT entries of i386 are addressed relative to the GOT itself, through a register, so `wrt ..got` can't be described
+        if (fixup.size == 8 || fixup.kind == reaver::assembler::fixup::kinds::got
+            || fixup.kind == reaver::assembler::fixup::kinds::got_rex)
+        {
+            return false;
+        }
+
+        std::uint32_t type = fixup.size == 4 ? r_386_32 : fixup.size == 2 ? r_386_16 : r_386_8;
+
+        if (fixup.relative())
+        {
+            type = fixup.size == 4 ? r_386_pc32 : fixup.size == 2 ? r_386_pc16 : r_386_pc8;
+        }
+
+        ret = { static_cast<std::uint32_t>(fixup.offset), (symbol << 8) | type };
+        return true;
+    }
+};
+
+struct reaver::assembler::elf64::format
+{
+    using header = elf64::header;
+    using section_header = elf64::section_header;
+    using symbol = elf64::symbol;
+    using relocation = elf64::relocation_addend;
+
+    static constexpr std::uint32_t relocation_section = elf::rela;
+    static constexpr std::uint64_t table_alignment = 8;
+    static constexpr bool implicit_addends = false;
+
+    static const char * relocation_prefix()
+    {
+        return ".rela";
+    }
+
+    static bool relocate(const reaver::assembler::fixup & fixup, std::uint32_t symbol, std::int64_t addend, relocation & ret)
+    {
+        using namespace reaver::assembler::elf;
+
+        std::uint32_t type = r_x86_64_8;
+
+        // the linker can turn GOT loads into `lea` (and indirect calls into direct ones) when the symbol turns out to be
+        // local, and calls through the PLT into direct ones when it doesn't need the PLT
+        if (fixup.kind == reaver::assembler::fixup::kinds::got || fixup.kind == reaver::assembler::fixup::kinds::got_rex)
+        {
+            if (fixup.size != 4)
+            {
+                return false;
+            }
+
+            type = fixup.kind == reaver::assembler::fixup::kinds::got_rex ? r_x86_64_rex_gotpcrelx : r_x86_64_gotpcrelx;
+        }
+
+        else if (fixup.kind == reaver::assembler::fixup::kinds::branch && fixup.size == 4 && symbol)
+        {
+            type = r_x86_64_plt32;
+        }
+
+        else if (fixup.relative())
+        {
+            type = fixup.size == 4 ? r_x86_64_pc32 : fixup.size == 2 ? r_x86_64_pc16 : r_x86_64_pc8;
+        }
+
+        else if (fixup.size == 8)
+        {
+            type = r_x86_64_64;
+        }
+
+        else if (fixup.size == 4)
+        {
+            type = fixup.kind == reaver::assembler::fixup::kinds::absolute_signed ? r_x86_64_32s : r_x86_64_32;
+        }
+
+        else if (fixup.size == 2)
+        {
+            type = r_x86_64_16;
+        }
+
+        ret = { fixup.offset, (static_cast<std::uint64_t>(symbol) << 32) | type, addend };
+        return true;
+    }
+};
+
+template<typename Format>
+void reaver::assembler::elf_writer<Format>::operator()(const reaver::assembler::module & output) const
+{
+    const auto & sections = output.sections();
+    const auto & symbols = output.symbols();
+    const auto & names = _front.symbols();
+
+    // section indices: the null section, the sections of the module, their relocations, then the symbol and string tables;
+    // when the sections of the module don't all fit in the 16-bit fields of the symbols, a table of extended section
+    // indices goes right before the symbol table
+    std::vector<std::uint32_t> relocation_index(sections.size());
+    std::uint32_t count = 1 + sections.size();
+
+    for (std::uint32_t i = 0; i < sections.size(); ++i)
+    {
+        relocation_index[i] = sections[i].fixups().empty() ? 0 : count++;
+    }
+
+    auto extended = sections.size() >= elf::reserved_index;
+    auto indices_index = extended ? count++ : 0;
+    auto symtab_index = count++;
+    auto strtab_index = count++;
+    auto shstrtab_index = count++;
+
+    // both string tables are filled before the layout is planned, so that they can be laid out (and their tails merged) once
+    string_table strtab;
+    string_table shstrtab;
+
+    std::vector<std::uint32_t> symbol_key(symbols.size());
+    std::vector<std::uint32_t> section_key(sections.size());
+    std::vector<std::uint32_t> relocation_key(sections.size());
+
+    for (std::uint32_t i = 0; i < symbols.size(); ++i)
+    {
+        symbol_key[i] = strtab.add(names.name(i));
+    }
+
+    for (std::uint32_t i = 0; i < sections.size(); ++i)
+    {
+        section_key[i] = shstrtab.add(sections[i].name());
+
+        if (relocation_index[i])
+        {
+            relocation_key[i] = shstrtab.add_copy(Format::relocation_prefix() + sections[i].name().to_string());
+        }
+    }
+
+    auto indices_key = extended ? shstrtab.add(".symtab_shndx") : 0;
+    auto symtab_key = shstrtab.add(".symtab");
+    auto strtab_key = shstrtab.add(".strtab");
+    auto shstrtab_key = shstrtab.add(".shstrtab");
+
+    strtab.finish();
+    shstrtab.finish();
+
+    // the symbol table has the null symbol, a symbol for every section (for relocations against local symbols), then the
+    // rest of the local symbols, and the global and external ones at the end
+    std::vector<typename Format::symbol> symtab(1 + sections.size() + symbols.size(), typename Format::symbol{});
+    std::vector<std::uint32_t> symtab_indices(extended ? symtab.size() : 0);
+    std::vector<std::uint32_t> symbol_index(symbols.size());
+
+    auto place_symbol = [&](std::uint32_t entry, std::uint32_t section)
+    {
+        if (section >= elf::reserved_index)
+        {
+            symtab[entry].section_table_index = elf::extended_index;
+            symtab_indices[entry] = section;
+            return;
+        }
+
+        symtab[entry].section_table_index = section;
+    };
+
+    for (std::uint32_t i = 0; i < sections.size(); ++i)
+    {
+        symtab[1 + i].info = elf::section_symbol;
+        place_symbol(1 + i, 1 + i);
+    }
+
+    std::uint32_t next = 1 + sections.size();
+
+    auto add_symbol = [&](std::uint32_t i, std::uint8_t binding)
+    {
+        auto & entry = symtab[next];
+        entry.name = strtab.offset(symbol_key[i]);
+        entry.info = (binding << 4) | elf::type_of(symbols[i].type);
+        entry.other = static_cast<std::uint8_t>(symbols[i].visibility);
+        place_symbol(next, symbols[i].section == undefined_section ? 0 : 1 + symbols[i].section);
+        entry.value = symbols[i].value;
+        entry.size = symbols[i].size;
+
+        symbol_index[i] = next++;
+    };
+
+    for (std::uint32_t i = 0; i < symbols.size(); ++i)
+    {
+        if (symbols[i].binding == symbol::bindings::local)
+        {
+            add_symbol(i, elf::local_binding);
+        }
+    }
+
+    auto first_global = next;
+
+    for (std::uint32_t i = 0; i < symbols.size(); ++i)
+    {
+        if (symbols[i].binding != symbol::bindings::local)
+        {
+            add_symbol(i, elf::global_binding);
+        }
+    }
+
+    // relocations against local symbols go through the symbol of their section, like everyone else does it, except in
+    // mergeable sections, where the linker needs the symbol to tell which entry is referred to, and for GOT entries, which
+    // belong to symbols; implicit addends are patched into the output file as it is written, at offsets within their
+    // sections for now
+    std::vector<std::vector<typename Format::relocation>> relocations(sections.size());
+    std::vector<utils::output_file::patch> patches;
+    std::vector<std::size_t> first_patch(sections.size() + 1);
+
+    for (std::uint32_t i = 0; i < sections.size(); ++i)
+    {
+        relocations[i].reserve(sections[i].fixups().size());
+        first_patch[i] = patches.size();
+
+        for (const auto & fixup : sections[i].fixups())
+        {
+            std::uint32_t symbol = 0;
+            auto addend = fixup.addend;
+
+            if (fixup.symbol != no_symbol && symbols[fixup.symbol].binding == symbol::bindings::local
+                && !sections[symbols[fixup.symbol].section].entry_size() && fixup.kind != fixup::kinds::got
+                && fixup.kind != fixup::kinds::got_rex)
+            {
+                symbol = 1 + symbols[fixup.symbol].section;
+                addend += symbols[fixup.symbol].value;
+            }
+
+            else if (fixup.symbol != no_symbol)
+            {
+                symbol = symbol_index[fixup.symbol];
+            }
+
+            else if (fixup.section != undefined_section)
+            {
+                symbol = 1 + fixup.section;
+            }
+
+            typename Format::relocation relocation;
+
+            if (!Format::relocate(fixup, symbol, addend, relocation))
+            {
+                _engine.push(exception(logger::error) << "reference to `" << (fixup.symbol == no_symbol ? std::string{ "<absolute>" }
+                    : names.name(fixup.symbol).to_string()) << "` can't be relocated in `" << _front.format() << "` output.");
+                continue;
+            }
+
+            relocations[i].push_back(relocation);
+
+            if (Format::implicit_addends)
+            {
+                patches.push_back({ fixup.offset, static_cast<std::uint64_t>(addend), fixup.size });
+            }
+        }
+    }
+
+    first_patch.back() = patches.size();
+
+    if (!_engine)
+    {
+        throw std::move(_engine);
+    }
+
+    // the layout, in the order of writing
+    typename Format::header header;
+    std::vector<typename Format::section_header> section_headers(count, typename Format::section_header{});
+    std::vector<iovec> parts;
+    std::uint64_t offset = sizeof(header);
+
+    parts.push_back({ &header, sizeof(header) });
+
+    auto place = [&](std::uint32_t index, const void * data, std::uint64_t size, std::uint64_t alignment)
+    {
+        auto aligned = _align(offset, alignment);
+        parts.push_back({ const_cast<std::uint8_t *>(_zeros), aligned - offset });
+
+        section_headers[index].offset = aligned;
+        section_headers[index].size = size;
+        section_headers[index].alignment = alignment;
+
+        parts.push_back({ const_cast<void *>(data), size });
+        offset = aligned + size;
+    };
+
+    for (std::uint32_t i = 0; i < sections.size(); ++i)
+    {
+        auto & section_header = section_headers[1 + i];
+        section_header.name = shstrtab.offset(section_key[i]);
+        elf::describe(sections[i], section_header);
+
+        if (section_header.type == elf::nobits)
+        {
+            section_header.offset = offset;
+            section_header.size = sections[i].size();
+        }
+
+        else
+        {
+            place(1 + i, sections[i].bytes().data(), sections[i].size(), section_header.alignment);
+        }
+
+        // nothing of a section without contents is in the file, so neither are its addends
+        for (auto patch = first_patch[i]; patch < first_patch[i + 1]; ++patch)
+        {
+            patches[patch].offset += section_header.offset;
+            patches[patch].size = section_header.type == elf::nobits ? 0 : patches[patch].size;
+        }
+    }
+
+    for (std::uint32_t i = 0; i < sections.size(); ++i)
+    {
+        if (!relocation_index[i])
+        {
+            continue;
+        }
+
+        auto & section_header = section_headers[relocation_index[i]];
+        section_header.name = shstrtab.offset(relocation_key[i]);
+
+        section_header.type = Format::relocation_section;
+        section_header.link = symtab_index;
+        section_header.info = 1 + i;
+        section_header.entries_size = sizeof(typename Format::relocation);
+
+        place(relocation_index[i], relocations[i].data(), relocations[i].size() * sizeof(typename Format::relocation),
+            Format::table_alignment);
+    }
+
+    if (extended)
+    {
+        section_headers[indices_index].name = shstrtab.offset(indices_key);
+        section_headers[indices_index].type = elf::symtab_indices;
+        section_headers[indices_index].link = symtab_index;
+        section_headers[indices_index].entries_size = sizeof(std::uint32_t);
+        place(indices_index, symtab_indices.data(), symtab_indices.size() * sizeof(std::uint32_t), 4);
+    }
+
+    section_headers[symtab_index].name = shstrtab.offset(symtab_key);
+    section_headers[symtab_index].type = elf::symtab;
+    section_headers[symtab_index].link = strtab_index;
+    section_headers[symtab_index].info = first_global;
+    section_headers[symtab_index].entries_size = sizeof(typename Format::symbol);
+    place(symtab_index, symtab.data(), symtab.size() * sizeof(typename Format::symbol), Format::table_alignment);
+
+    section_headers[strtab_index].name = shstrtab.offset(strtab_key);
+    section_headers[strtab_index].type = elf::strtab;
+    place(strtab_index, strtab.data().data(), strtab.data().size(), 1);
+
+    section_headers[shstrtab_index].name = shstrtab.offset(shstrtab_key);
+    section_headers[shstrtab_index].type = elf::strtab;
+    place(shstrtab_index, shstrtab.data().data(), shstrtab.data().size(), 1);
+
+    header.section_header_offset = _align(offset, Format::table_alignment);
+    header.section_header_entry_count = count;
+    header.section_name_table_index = shstrtab_index;
+
+    if (count >= elf::reserved_index)
+    {
+        header.section_header_entry_count = 0;
+        section_headers[0].size = count;
+    }
+
+    if (shstrtab_index >= elf::reserved_index)
+    {
+        header.section_name_table_index = elf::extended_index;
+        section_headers[0].link = shstrtab_index;
+    }
+
+    parts.push_back({ const_cast<std::uint8_t *>(_zeros), header.section_header_offset - offset });
+    parts.push_back({ section_headers.data(), section_headers.size() * sizeof(typename Format::section_header) });
+
+    auto size = header.section_header_offset + section_headers.size() * sizeof(typename Format::section_header);
+
+    utils::output_file file{ _front.output_name() };
+
+    if (!file || !file.preallocate(size) || !file.write(std::move(parts), std::move(patches), _front.jobs()) || !file.commit())
+    {
+        _engine.push(exception(logger::error) << "failed to write output file `" << _front.output_name() << "`: "
+            << std::strerror(errno) << ".");
+        throw std::move(_engine);
+    }
+}
+
+template class reaver::assembler::elf_writer<reaver::assembler::elf32::format>;
+template class reaver::assembler::elf_writer<reaver::assembler::elf64::format>;
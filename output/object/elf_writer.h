@@ -0,0 +1,140 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <algorithm>
+
+#include <reaver/error.h>
+
+#include "../../frontend/frontend.h"
+#include "../module.h"
+#include "elf.h"
+
+namespace reaver
+{
+    namespace assembler
+    {
+        namespace elf
+        {
+            // type and flags of a section are implied by its name, and by its attributes
+            template<typename SectionHeader>
+            void describe(const section & section, SectionHeader & header)
+            {
+                auto name = section.name();
+                auto starts_with = [&](boost::string_ref prefix)
+                {
+                    return name.size() >= prefix.size() && name.substr(0, prefix.size()) == prefix;
+                };
+
+                header.type = progbits;
+                header.flags = allocated;
+                header.alignment = std::max<std::uint64_t>(16, section.entry_size());
+
+                if (section.entry_size())
+                {
+                    header.flags |= section.strings() ? mergeable | strings : mergeable;
+                    header.entries_size = section.entry_size();
+                }
+
+                if (section.uninitialized())
+                {
+                    header.type = nobits;
+                    header.flags |= writable;
+                }
+
+                else if (starts_with(".text"))
+                {
+                    header.flags |= executable;
+                }
+
+                else if (starts_with(".data"))
+                {
+                    header.flags |= writable;
+                }
+
+                // debugging information isn't loaded
+                else if (starts_with(".debug"))
+                {
+                    header.flags = 0;
+                    header.alignment = 1;
+                }
+
+                // linkers concatenate the frames of all the objects, and any padding put between them by an alignment
+                // larger than the address size the records are padded to would read as a terminator
+                else if (name == ".eh_frame")
+                {
+                    header.alignment = sizeof(header.virtual_address);
+                }
+            }
+
+            inline std::uint8_t type_of(assembler::symbol_types type)
+            {
+                switch (type)
+                {
+                    case assembler::symbol_types::function:
+                        return function_symbol;
+
+                    case assembler::symbol_types::object:
+                        return object_symbol;
+
+                    default:
+                        return no_type;
+                }
+            }
+        }
+
+        namespace elf32
+        {
+            struct format;
+        }
+
+        namespace elf64
+        {
+            struct format;
+        }
+
+        // writes a relocatable ELF object; `Format` picks the class of the file and the relocation flavour (implicit addends
+        // for ELF32, explicit ones for ELF64)
+        //
+        // the whole layout is planned before anything is written; the file is then preallocated to its final size and
+        // written with a single series of writev calls, straight from the section buffers of the module and from the
+        // tables built during planning
+        template<typename Format>
+        class elf_writer
+        {
+        public:
+            elf_writer(const frontend & front, error_engine & engine) : _front{ front }, _engine{ engine }
+            {
+            }
+
+            void operator()(const module &) const;
+
+        private:
+            const frontend & _front;
+            error_engine & _engine;
+        };
+
+        using elf32_writer = elf_writer<elf32::format>;
+        using elf64_writer = elf_writer<elf64::format>;
+    }
+}
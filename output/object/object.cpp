@@ -21,9 +21,34 @@
 **/
 
 #include "object.h"
+#include "binary_writer.h"
+#include "elf_writer.h"
 
-void reaver::assembler::object_output::operator()(const std::unique_ptr<reaver::format::executable::executable> &) const
+void reaver::assembler::object_output::operator()(const reaver::assembler::module & output) const
 {
-    _engine.push(exception(logger::crash) << "not implemented yet: " << __PRETTY_FUNCTION__);
+    if (!_engine)
+    {
+        throw std::move(_engine);
+    }
+
+    if (_front.format() == "binary")
+    {
+        binary_writer{ _front, _engine }(output);
+        return;
+    }
+
+    if (_front.format() == "elf32")
+    {
+        elf32_writer{ _front, _engine }(output);
+        return;
+    }
+
+    if (_front.format() == "elf64")
+    {
+        elf64_writer{ _front, _engine }(output);
+        return;
+    }
+
+    _engine.push(exception(logger::crash) << "not implemented yet: `" << _front.format() << "` output.");
     throw std::move(_engine);
 }
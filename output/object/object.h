@@ -32,19 +32,18 @@ namespace reaver
         {
         public:
             object_output(const frontend & front, error_engine & engine) : _front{ front }, _engine{ engine }, _triple{
-                front.target() }, _format{ format::executable::make_format(front.format()) }
+                front.target() }
             {
             }
 
             virtual ~object_output() {}
 
-            virtual void operator()(const std::unique_ptr<format::executable::executable> &) const override;
+            virtual void operator()(const module &) const override;
 
         private:
             const frontend & _front;
             error_engine & _engine;
             target::triple _triple;
-            format::executable::format _format;
         };
     }
 }
@@ -0,0 +1,89 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include "string_table.h"
+
+namespace
+{
+    // true if `lhs` goes before `rhs` when compared from their last bytes backwards, with the longer one first if one of them
+    // is a tail of the other
+    bool _tail_order(boost::string_ref lhs, boost::string_ref rhs)
+    {
+        auto lhs_it = lhs.rbegin(), rhs_it = rhs.rbegin();
+
+        for (; lhs_it != lhs.rend() && rhs_it != rhs.rend(); ++lhs_it, ++rhs_it)
+        {
+            if (*lhs_it != *rhs_it)
+            {
+                return static_cast<unsigned char>(*lhs_it) > static_cast<unsigned char>(*rhs_it);
+            }
+        }
+
+        return lhs.size() > rhs.size();
+    }
+
+    bool _ends_with(boost::string_ref name, boost::string_ref tail)
+    {
+        return name.size() >= tail.size() && name.substr(name.size() - tail.size()) == tail;
+    }
+}
+
+void reaver::assembler::string_table::finish()
+{
+    std::vector<std::uint32_t> order(_names.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::uint32_t lhs, std::uint32_t rhs){ return _tail_order(_names.name(lhs),
+        _names.name(rhs)); });
+
+    // in this order, if a name is a tail of any other, it is a tail of the one right before it
+    _offsets.resize(_names.size());
+    std::vector<std::uint32_t> stored;
+    std::uint32_t size = 1;
+
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        auto name = _names.name(order[i]);
+
+        if (i && _ends_with(_names.name(order[i - 1]), name))
+        {
+            _offsets[order[i]] = _offsets[order[i - 1]] + _names.name(order[i - 1]).size() - name.size();
+            continue;
+        }
+
+        _offsets[order[i]] = size;
+        size += name.size() + 1;
+        stored.push_back(order[i]);
+    }
+
+    // the terminators come from zeroing the table
+    _data.assign(size, 0);
+
+    for (auto key : stored)
+    {
+        auto name = _names.name(key);
+        std::memcpy(_data.data() + _offsets[key], name.data(), name.size());
+    }
+}
@@ -0,0 +1,86 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/utility/string_ref.hpp>
+
+#include "../../parser/symbol_table.h"
+
+namespace reaver
+{
+    namespace assembler
+    {
+        // an ELF string table, built in two steps
+        //
+        // names are added first; equal names are deduplicated through the same hashed index the symbols of a run are
+        // interned in, and every distinct name gets a key. `finish()` then lays the table out: the names are sorted by their
+        // reversed bytes, so a name that is a tail of another one (like `foo` of `.text.foo`) lands right after it and
+        // shares its bytes, the size is known before anything is copied, and every name that is stored is copied once
+        //
+        // offsets are only valid after `finish()`; nothing can be added after it
+        class string_table
+        {
+        public:
+            string_table() = default;
+            string_table(const string_table &) = delete;
+            string_table & operator=(const string_table &) = delete;
+
+            // the name isn't copied, so it must live as long as the table does
+            std::uint32_t add(boost::string_ref name)
+            {
+                return _names.intern(name);
+            }
+
+            // for names that are put together only for the table
+            std::uint32_t add_copy(std::string name)
+            {
+                _copies.push_back(std::move(name));
+                return add(_copies.back());
+            }
+
+            void finish();
+
+            std::uint32_t offset(std::uint32_t key) const
+            {
+                return _offsets[key];
+            }
+
+            const std::vector<char> & data() const
+            {
+                return _data;
+            }
+
+        private:
+            symbol_table _names;
+            std::deque<std::string> _copies;
+
+            std::vector<std::uint32_t> _offsets;
+            std::vector<char> _data;
+        };
+    }
+}
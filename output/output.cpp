@@ -23,24 +23,24 @@
 #include <reaver/error.h>
 
 #include "output.h"
-#include "text/text.h"
 #include "object/object.h"
+#include "linker/linker.h"
 
 std::unique_ptr<reaver::assembler::output> reaver::assembler::create_output(const reaver::assembler::frontend & front,
     reaver::error_engine & engine)
 {
-    if (front.preprocess_only())
+    // flat binaries are complete as they are assembled; there's nothing to link them with
+    if (front.assemble_only() || front.format() == "binary")
     {
-        return std::make_unique<text_output>(front, engine);
+        return std::make_unique<object_output>(front, engine);
     }
 
-    if (front.assemble_only())
+    if (front.format() == "elf64")
     {
-        return std::make_unique<object_output>(front, engine);
+        return std::make_unique<linker_output>(front, engine);
     }
 
-    engine.push(exception(logger::crash) << "linker plugin not implemented yet, use -s to disable it.");
+    engine.push(exception(logger::error) << "linking `" << front.format() << "` objects is not supported; use -s to only "
+        "assemble them.");
     throw std::move(engine);
-//    std::unique_ptr<linker::frontend> linker_front{ new linker::assembler_frontend{ front, engine } };
-//    return std::unique_ptr<output>{ new linker_output{ linker_front, gen, engine } };
 }
@@ -24,11 +24,10 @@
 
 #include <memory>
 
-#include <reaver/format/executable.h>
-
 #include "../frontend/frontend.h"
 #include "../generator/generator.h"
 #include "../parser/ast.h"
+#include "module.h"
 
 namespace reaver
 {
@@ -43,7 +42,7 @@ namespace reaver
 
             virtual ~output() {}
 
-            virtual void operator()(const std::unique_ptr<format::executable::executable> &) const = 0;
+            virtual void operator()(const module &) const = 0;
         };
 
         std::unique_ptr<output> create_output(const frontend &, error_engine &);
@@ -0,0 +1,170 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <boost/utility/string_ref.hpp>
+
+#include "../parser/symbol_table.h"
+
+namespace reaver
+{
+    namespace assembler
+    {
+        constexpr std::uint32_t undefined_section = std::numeric_limits<std::uint32_t>::max();
+
+        // a field of a section that can only be filled in once the symbol's address is known
+        struct fixup
+        {
+            enum class kinds : std::uint8_t
+            {
+                absolute,           // S + A
+                absolute_signed,    // S + A, sign extended by the cpu to the operand size
+                relative,           // S + A - P, where P is the offset of the field
+                branch,             // S + A - P, the target of a call or a jump; may go through the PLT
+                got,                // G + GOT + A - P, the GOT entry of the symbol (`wrt ..got`)
+                got_rex             // as above, in an instruction with a REX prefix; lets the linker tell how to relax it
+            };
+
+            // all but the absolute kinds are relative to the field
+            bool relative() const
+            {
+                return kind != kinds::absolute && kind != kinds::absolute_signed;
+            }
+
+            // whether the resolved value can be stored in the field; absolute fields may also hold unsigned values
+            bool fits(std::int64_t value) const
+            {
+                if (size == 8)
+                {
+                    return true;
+                }
+
+                auto limit = std::int64_t{ 1 } << (8 * size - 1);
+                return value >= -limit && value < (kind == kinds::absolute ? 2 * limit : limit);
+            }
+
+            std::uint64_t offset;
+            std::int64_t addend;
+            std::uint32_t symbol;   // `no_symbol` when the addend is an absolute address, or an offset into `section`
+            std::uint8_t size;
+            kinds kind;
+            std::uint32_t section = undefined_section;
+        };
+
+        // the contents of a section are kept as they are meant to be written; encoders append straight into `bytes()`, and
+        // leave the fields described by `fixups()` zeroed
+        //
+        // a section without contents (`.bss`, or one given the `nobits` attribute) only keeps its size; its `bytes()` stay
+        // empty, and nothing of it is in the output file
+        class section
+        {
+        public:
+            section(boost::string_ref name) : _name{ name }, _uninitialized{ name.size() >= 4 && name.substr(0, 4) == ".bss" }
+            {
+            }
+
+            boost::string_ref name() const
+            {
+                return _name;
+            }
+
+            std::vector<std::uint8_t> & bytes()
+            {
+                return _bytes;
+            }
+
+            const std::vector<std::uint8_t> & bytes() const
+            {
+                return _bytes;
+            }
+
+            std::vector<fixup> & fixups()
+            {
+                return _fixups;
+            }
+
+            const std::vector<fixup> & fixups() const
+            {
+                return _fixups;
+            }
+
+            std::uint64_t size() const
+            {
+                return _bytes.size() + _reserved;
+            }
+
+            bool uninitialized() const
+            {
+                return _uninitialized;
+            }
+
+            void uninitialized(bool value)
+            {
+                _uninitialized = value;
+            }
+
+            // appends `size` zero bytes; a section without contents only counts them
+            void extend(std::uint64_t size)
+            {
+                if (_uninitialized)
+                {
+                    _reserved += size;
+                    return;
+                }
+
+                _bytes.resize(_bytes.size() + size, 0);
+            }
+
+            // a mergeable section holds entries the linker may fold with equal ones from other objects: either constants of
+            // `entry_size()` bytes, or zero terminated strings of characters of that size; 0 for ordinary sections
+            std::uint8_t entry_size() const
+            {
+                return _entry_size;
+            }
+
+            bool strings() const
+            {
+                return _strings;
+            }
+
+            void merge(std::uint8_t entry_size, bool strings)
+            {
+                _entry_size = entry_size;
+                _strings = strings;
+            }
+
+        private:
+            boost::string_ref _name;
+            std::uint8_t _entry_size = 0;
+            bool _strings = false;
+            bool _uninitialized;
+            std::uint64_t _reserved = 0;
+            std::vector<std::uint8_t> _bytes;
+            std::vector<fixup> _fixups;
+        };
+    }
+}
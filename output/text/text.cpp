@@ -20,17 +20,77 @@
  *
  **/
 
-#include <iostream>
+#include <cerrno>
+#include <cstring>
 
 #include "text.h"
 
-void reaver::assembler::text_output::operator()(const std::unique_ptr<format::executable::executable> & exec) const
+namespace
 {
-    if (!_engine)
+    constexpr std::size_t _buffer_size = 1 << 20;
+}
+
+reaver::assembler::text_output::text_output(const reaver::assembler::frontend & front, reaver::error_engine & engine)
+    : _front{ front }, _engine{ engine }, _file{ front.output_name() }
+{
+    if (!_file)
+    {
+        _fail();
+    }
+
+    _buffer.reserve(_buffer_size);
+}
+
+void reaver::assembler::text_output::operator()(reaver::assembler::utils::bounded_queue<reaver::assembler::line> & lines)
+{
+    while (auto l = lines.pop())
     {
-        throw std::move(_engine);
+        const auto & text = l->preprocessed;
+
+        if (_buffer.size() + text.size() + 1 > _buffer_size)
+        {
+            _flush();
+        }
+
+        // a line longer than the whole buffer is written as it is
+        if (text.size() + 1 > _buffer_size)
+        {
+            if (!_file.append(text.data(), text.size()) || !_file.append("\n", 1))
+            {
+                _fail();
+            }
+
+            continue;
+        }
+
+        _buffer.insert(_buffer.end(), text.begin(), text.end());
+        _buffer.push_back('\n');
     }
+}
 
-    auto section = exec->sections().begin()->second;
-    _front.output().write(reinterpret_cast<const char *>(section.blob().data()), section.size());
+void reaver::assembler::text_output::finish()
+{
+    _flush();
+
+    if (!_file.commit())
+    {
+        _fail();
+    }
+}
+
+void reaver::assembler::text_output::_flush()
+{
+    if (!_file.append(_buffer.data(), _buffer.size()))
+    {
+        _fail();
+    }
+
+    _buffer.clear();
+}
+
+void reaver::assembler::text_output::_fail()
+{
+    _engine.push(exception(logger::error) << "failed to write output file `" << _front.output_name() << "`: "
+        << std::strerror(errno) << ".");
+    throw std::move(_engine);
 }
@@ -22,28 +22,41 @@
 
 #pragma once
 
+#include <vector>
+
 #include <reaver/error.h>
 
-#include "../output.h"
+#include "../../frontend/frontend.h"
+#include "../../preprocessor/line.h"
+#include "../../utils/bounded_queue.h"
+#include "../../utils/output_file.h"
 
 namespace reaver
 {
     namespace assembler
     {
-        class text_output : public output
+        // writes the preprocessed lines out as the preprocessor produces them, through a buffer of a fixed size; the
+        // output never exists in memory as a whole
+        //
+        // the file is only moved into place by `finish()`, once the preprocessor is known to have succeeded
+        class text_output
         {
         public:
-            text_output(const frontend & front, error_engine & engine) : _front{ front }, _engine{ engine }
-            {
-            }
-
-            virtual ~text_output() {}
+            text_output(const frontend & front, error_engine & engine);
 
-            virtual void operator()(const std::unique_ptr<format::executable::executable> &) const override;
+            // consumes the queue until it is closed
+            void operator()(utils::bounded_queue<line> &);
+            void finish();
 
         private:
+            void _flush();
+            void _fail();
+
             const frontend & _front;
             error_engine & _engine;
+
+            utils::output_file _file;
+            std::vector<char> _buffer;
         };
     }
 }
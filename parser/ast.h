@@ -22,12 +22,164 @@
 
 #pragma once
 
+#include <cstdint>
+#include <vector>
+#include <iterator>
+
+#include <boost/variant.hpp>
+
+#include "operand.h"
+
 namespace reaver
 {
     namespace assembler
     {
+        namespace intel
+        {
+            struct mnemonic;
+        }
+
+        struct instruction
+        {
+            const intel::mnemonic * mnemonic = nullptr;
+            std::uint8_t operand_count = 0;
+            operand operands[3];
+        };
+
+        struct label
+        {
+            std::uint32_t symbol;
+        };
+
+        // a single `db`-family operand; either a string or an expression
+        struct data_item
+        {
+            boost::string_ref string;
+            expression value;
+        };
+
+        struct data
+        {
+            std::uint8_t size;
+            std::vector<data_item> items;
+        };
+
+        // `resb`-family; `count` items of `size` bytes, without values
+        struct reservation
+        {
+            std::uint8_t size;
+            std::uint64_t count;
+        };
+
+        struct bits_directive
+        {
+            std::uint8_t bits;
+        };
+
+        struct section_directive
+        {
+            boost::string_ref name;
+            // `merge=<size>` and `strings`; see section::entry_size()
+            std::uint8_t entry_size = 0;
+            bool strings = false;
+            // `nobits`; see section::uninitialized()
+            bool nobits = false;
+        };
+
+        struct global_directive
+        {
+            std::uint32_t symbol;
+            symbol_types type = symbol_types::none;
+            // whether `visibility` was given at all; the default one can be changed from the command line
+            bool visible = false;
+            symbol_visibilities visibility = symbol_visibilities::default_visibility;
+        };
+
+        struct extern_directive
+        {
+            std::uint32_t symbol;
+        };
+
+        // `size name, <size>`; the size is either a constant, or a symbol (plus a constant) marking the end of the symbol
+        struct size_directive
+        {
+            std::uint32_t symbol;
+            expression size;
+        };
+
+        struct org_directive
+        {
+            std::uint64_t address;
+        };
+
+        // call frame information, describing how to unwind the code that follows it; turned into `.eh_frame`
+        struct cfi_directive
+        {
+            enum class kinds : std::uint8_t
+            {
+                startproc,
+                endproc,
+                def_cfa,            // register, offset
+                def_cfa_register,   // register
+                def_cfa_offset,     // offset
+                adjust_cfa_offset,  // offset
+                offset,             // register, offset (from the cfa)
+                restore,            // register
+                remember_state,
+                restore_state
+            };
+
+            kinds kind;
+            register_id reg;
+            std::int64_t offset;
+        };
+
+        struct statement
+        {
+            template<typename T>
+            statement(std::uint32_t loc, T && t) : location{ loc }, value{ std::forward<T>(t) }
+            {
+            }
+
+            std::uint32_t location;
+            boost::variant<instruction, label, data, reservation, bits_directive, section_directive, global_directive, extern_directive,
+                org_directive, size_directive, cfi_directive> value;
+        };
+
         class ast
         {
+        public:
+            template<typename T>
+            void push(std::uint32_t location, T && t)
+            {
+                _statements.emplace_back(location, std::forward<T>(t));
+            }
+
+            // appends a fragment produced by a streaming parser; fragments are always appended in source order
+            void append(ast && other)
+            {
+                if (_statements.empty())
+                {
+                    _statements = std::move(other._statements);
+                    return;
+                }
+
+                _statements.insert(_statements.end(), std::make_move_iterator(other._statements.begin()),
+                    std::make_move_iterator(other._statements.end()));
+            }
+
+            const std::vector<statement> & statements() const
+            {
+                return _statements;
+            }
+
+            std::size_t size() const
+            {
+                return _statements.size();
+            }
+
+        private:
+            std::vector<statement> _statements;
         };
     }
 }
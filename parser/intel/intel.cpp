@@ -20,10 +20,1604 @@
  *
  **/
 
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <algorithm>
+
 #include "intel.h"
+#include "../../generator/intel/opcodes.h"
+#include "../../preprocessor/source_buffer.h"
+#include "../symbol_table.h"
+
+using namespace reaver::assembler::operand_classes;
+
+namespace
+{
+    struct _syntax_error
+    {
+        std::string message;
+    };
+
+    reaver::assembler::expression _constant(std::int64_t value)
+    {
+        reaver::assembler::expression ret;
+        ret.value = value;
+        return ret;
+    }
+
+    // constant arithmetic wraps around, like the fields the values end up in, so it's done on unsigned values
+    std::int64_t _wrap(std::uint64_t value)
+    {
+        return static_cast<std::int64_t>(value);
+    }
+
+    struct _register
+    {
+        const char * name;
+        std::uint64_t classes;
+        reaver::assembler::register_id id;
+    };
+
+    constexpr std::uint64_t _gp8 = r8 | rm8;
+    constexpr std::uint64_t _gp16 = r16 | rm16 | r16m16;
+    constexpr std::uint64_t _gp32 = r32 | rm32 | r32m16;
+    constexpr std::uint64_t _gp64 = r64 | rm64;
+
+    constexpr auto general = reaver::assembler::register_id::general;
+    constexpr auto segment = reaver::assembler::register_id::segment;
+    constexpr auto control = reaver::assembler::register_id::control;
+    constexpr auto debug = reaver::assembler::register_id::debug;
+    constexpr auto instruction_pointer = reaver::assembler::register_id::instruction_pointer;
+
+    // sorted by name, so the lookup can do a binary search; the parser hands the id over to the generator, which never
+    // has to look at a register's name again
+    constexpr _register _registers[] = {
+        { "ah", _gp8, { general, 1, 4, false, true } }, { "al", _gp8 | al, { general, 1, 0 } },
+        { "ax", _gp16 | ax, { general, 2, 0 } }, { "bh", _gp8, { general, 1, 7, false, true } },
+        { "bl", _gp8, { general, 1, 3 } }, { "bp", _gp16, { general, 2, 5 } }, { "bpl", _gp8, { general, 1, 5, true } },
+        { "bx", _gp16, { general, 2, 3 } }, { "ch", _gp8, { general, 1, 5, false, true } }, { "cl", _gp8, { general, 1, 1 } },
+        { "cr0", creg, { control, 8, 0 } }, { "cr2", creg, { control, 8, 2 } }, { "cr3", creg, { control, 8, 3 } },
+        { "cr4", creg, { control, 8, 4 } }, { "cr8", cr8, { control, 8, 8 } }, { "cs", sreg, { segment, 2, 1 } },
+        { "cx", _gp16, { general, 2, 1 } }, { "dh", _gp8, { general, 1, 6, false, true } }, { "di", _gp16, { general, 2, 7 } },
+        { "dil", _gp8, { general, 1, 7, true } }, { "dl", _gp8, { general, 1, 2 } }, { "dr0", dreg, { debug, 8, 0 } },
+        { "dr1", dreg, { debug, 8, 1 } }, { "dr2", dreg, { debug, 8, 2 } }, { "dr3", dreg, { debug, 8, 3 } },
+        { "dr4", dreg, { debug, 8, 4 } }, { "dr5", dreg, { debug, 8, 5 } }, { "dr6", dreg, { debug, 8, 6 } },
+        { "dr7", dreg, { debug, 8, 7 } }, { "ds", sreg | ds, { segment, 2, 3 } }, { "dx", _gp16 | dx, { general, 2, 2 } },
+        { "eax", _gp32 | eax, { general, 4, 0 } }, { "ebp", _gp32, { general, 4, 5 } }, { "ebx", _gp32, { general, 4, 3 } },
+        { "ecx", _gp32, { general, 4, 1 } }, { "edi", _gp32, { general, 4, 7 } }, { "edx", _gp32, { general, 4, 2 } },
+        { "es", sreg | es, { segment, 2, 0 } }, { "esi", _gp32, { general, 4, 6 } }, { "esp", _gp32, { general, 4, 4 } },
+        { "fs", sreg | fs, { segment, 2, 4 } }, { "gs", sreg | gs, { segment, 2, 5 } }, { "r10", _gp64, { general, 8, 10 } },
+        { "r10b", _gp8, { general, 1, 10 } }, { "r10d", _gp32, { general, 4, 10 } }, { "r10w", _gp16, { general, 2, 10 } },
+        { "r11", _gp64, { general, 8, 11 } }, { "r11b", _gp8, { general, 1, 11 } }, { "r11d", _gp32, { general, 4, 11 } },
+        { "r11w", _gp16, { general, 2, 11 } }, { "r12", _gp64, { general, 8, 12 } }, { "r12b", _gp8, { general, 1, 12 } },
+        { "r12d", _gp32, { general, 4, 12 } }, { "r12w", _gp16, { general, 2, 12 } }, { "r13", _gp64, { general, 8, 13 } },
+        { "r13b", _gp8, { general, 1, 13 } }, { "r13d", _gp32, { general, 4, 13 } }, { "r13w", _gp16, { general, 2, 13 } },
+        { "r14", _gp64, { general, 8, 14 } }, { "r14b", _gp8, { general, 1, 14 } }, { "r14d", _gp32, { general, 4, 14 } },
+        { "r14w", _gp16, { general, 2, 14 } }, { "r15", _gp64, { general, 8, 15 } }, { "r15b", _gp8, { general, 1, 15 } },
+        { "r15d", _gp32, { general, 4, 15 } }, { "r15w", _gp16, { general, 2, 15 } }, { "r8", _gp64, { general, 8, 8 } },
+        { "r8b", _gp8, { general, 1, 8 } }, { "r8d", _gp32, { general, 4, 8 } }, { "r8w", _gp16, { general, 2, 8 } },
+        { "r9", _gp64, { general, 8, 9 } }, { "r9b", _gp8, { general, 1, 9 } }, { "r9d", _gp32, { general, 4, 9 } },
+        { "r9w", _gp16, { general, 2, 9 } }, { "rax", _gp64 | rax, { general, 8, 0 } }, { "rbp", _gp64, { general, 8, 5 } },
+        { "rbx", _gp64, { general, 8, 3 } }, { "rcx", _gp64, { general, 8, 1 } }, { "rdi", _gp64, { general, 8, 7 } },
+        { "rdx", _gp64, { general, 8, 2 } }, { "rip", 0, { instruction_pointer, 8, 5 } }, { "rsi", _gp64, { general, 8, 6 } },
+        { "rsp", _gp64, { general, 8, 4 } }, { "si", _gp16, { general, 2, 6 } }, { "sil", _gp8, { general, 1, 6, true } },
+        { "sp", _gp16, { general, 2, 4 } }, { "spl", _gp8, { general, 1, 4, true } }, { "ss", sreg | ss, { segment, 2, 2 } }
+    };
+
+    constexpr bool _less(const char * lhs, const char * rhs)
+    {
+        while (*lhs && *lhs == *rhs)
+        {
+            ++lhs;
+            ++rhs;
+        }
+        return static_cast<unsigned char>(*lhs) < static_cast<unsigned char>(*rhs);
+    }
+
+    constexpr bool _sorted()
+    {
+        for (std::size_t i = 1; i < sizeof(_registers) / sizeof(*_registers); ++i)
+        {
+            if (!_less(_registers[i - 1].name, _registers[i].name))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(_sorted(), "the register table must be sorted by name");
+
+    constexpr std::uint64_t _address_registers = r16 | r32 | r64;
+
+    bool _identifier_start(char c)
+    {
+        return std::isalpha(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '?' || c == '@';
+    }
+
+    bool _identifier_char(char c)
+    {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '?' || c == '@' || c == '$' || c == '#'
+            || c == '~';
+    }
+
+    // mnemonics, registers and keywords are case insensitive; returns an empty ref for anything too long to be one of those
+    template<std::size_t N>
+    boost::string_ref _lower(boost::string_ref word, char (& buffer)[N])
+    {
+        if (word.size() >= sizeof(buffer))
+        {
+            return {};
+        }
+
+        std::transform(word.begin(), word.end(), buffer, [](char c){ return std::tolower(static_cast<unsigned char>(c)); });
+        return { buffer, word.size() };
+    }
+
+    const _register * _find_register(boost::string_ref word)
+    {
+        char buffer[16];
+        auto name = _lower(word, buffer);
+
+        if (name.empty() || name.size() > 4)
+        {
+            return nullptr;
+        }
+
+        auto it = std::lower_bound(std::begin(_registers), std::end(_registers), name, [](const _register & reg, boost::string_ref name)
+        {
+            return boost::string_ref{ reg.name } < name;
+        });
+
+        if (it != std::end(_registers) && it->name == name)
+        {
+            return it;
+        }
+
+        return nullptr;
+    }
+
+    std::uint8_t _size(boost::string_ref word)
+    {
+        char buffer[16];
+        auto name = _lower(word, buffer);
+
+        if (name == "byte")
+        {
+            return 1;
+        }
+
+        if (name == "word")
+        {
+            return 2;
+        }
+
+        if (name == "dword")
+        {
+            return 4;
+        }
+
+        if (name == "qword")
+        {
+            return 8;
+        }
+
+        return 0;
+    }
+
+    std::uint64_t _immediate_classes(const reaver::assembler::expression & value, std::uint8_t size)
+    {
+        std::uint64_t ret = imm64;
+
+        if (!value.constant())
+        {
+            // the value isn't known until link time, so it can't be assumed to fit anything shorter than the native sizes;
+            // branches to it start out near, the generator is free to relax them later
+            ret |= imm16 | imm32 | rel16 | rel32;
+        }
+
+        else
+        {
+            auto v = value.value;
+
+            ret |= rel16 | rel32;
+
+            if (v >= -0x80000000ll && v <= 0xFFFFFFFFll)
+            {
+                ret |= imm32;
+            }
+
+            if (v >= -0x80000000ll && v <= 0x7FFFFFFFll)
+            {
+                ret |= simm32;
+            }
+
+            if (v >= -0x8000 && v <= 0xFFFF)
+            {
+                ret |= imm16;
+            }
+
+            if (v >= -0x80 && v <= 0xFF)
+            {
+                ret |= imm8;
+            }
+
+            if (v >= -0x80 && v <= 0x7F)
+            {
+                ret |= simm8 | rel8;
+            }
+        }
+
+        switch (size)
+        {
+            case 1:
+                return ret & (imm8 | simm8 | rel8);
+            case 2:
+                return ret & (imm16 | rel16);
+            case 4:
+                return ret & (imm32 | simm32 | rel32);
+            case 8:
+                return ret & imm64;
+        }
+
+        return ret & ~rel8;
+    }
+
+    std::uint64_t _memory_classes(std::uint8_t size)
+    {
+        switch (size)
+        {
+            case 1:
+                return m | rm8;
+            case 2:
+                return m | rm16 | r16m16 | r32m16;
+            case 4:
+                return m | rm32;
+            case 8:
+                return m | rm64;
+        }
+
+        return m | rm8 | rm16 | rm32 | rm64 | r16m16 | r32m16;
+    }
+
+    class _line_parser
+    {
+    public:
+        _line_parser(reaver::assembler::source_buffer & sources, reaver::assembler::symbol_table & symbols) : _sources{ sources },
+            _symbols{ symbols }
+        {
+        }
+
+        void operator()(const reaver::assembler::line & l, reaver::assembler::ast & output)
+        {
+            _text = l.preprocessed;
+            _position = 0;
+
+            _skip();
+
+            if (_done())
+            {
+                return;
+            }
+
+            if (_peek() == '[')
+            {
+                ++_position;
+                _directive(l.location, _identifier(), output, true);
+                _expect(']');
+                _finish();
+                return;
+            }
+
+            auto word = _identifier();
+
+            if (_directive(l.location, word, output))
+            {
+                _finish();
+                return;
+            }
+
+            if (auto mnemonic = _mnemonic(word))
+            {
+                _instruction(l.location, mnemonic, output);
+                return;
+            }
+
+            output.push(l.location, reaver::assembler::label{ _symbol(word, true) });
+
+            _skip();
+            if (!_done() && _peek() == ':')
+            {
+                ++_position;
+            }
+
+            _skip();
+            if (_done())
+            {
+                return;
+            }
+
+            word = _identifier();
+
+            if (auto mnemonic = _mnemonic(word))
+            {
+                _instruction(l.location, mnemonic, output);
+                return;
+            }
+
+            if (auto size = _data_size(word))
+            {
+                _data(l.location, size, output);
+                _finish();
+                return;
+            }
+
+            if (auto size = _reservation_size(word))
+            {
+                _reservation(l.location, size, output);
+                _finish();
+                return;
+            }
+
+            throw _syntax_error{ "invalid instruction mnemonic `" + word.to_string() + "`." };
+        }
+
+    private:
+        bool _done() const
+        {
+            return _position >= _text.size() || _text[_position] == ';';
+        }
+
+        char _peek() const
+        {
+            return _text[_position];
+        }
+
+        void _skip()
+        {
+            while (_position < _text.size() && std::isspace(static_cast<unsigned char>(_text[_position])))
+            {
+                ++_position;
+            }
+        }
+
+        bool _accept(char c)
+        {
+            _skip();
+
+            if (!_done() && _peek() == c)
+            {
+                ++_position;
+                return true;
+            }
+
+            return false;
+        }
+
+        void _expect(char c)
+        {
+            if (!_accept(c))
+            {
+                throw _syntax_error{ std::string{ "expected `" } + c + "`." };
+            }
+        }
+
+        void _finish()
+        {
+            _skip();
+
+            if (!_done())
+            {
+                throw _syntax_error{ "garbage at the end of a line: `" + _text.substr(_position).to_string() + "`." };
+            }
+        }
+
+        boost::string_ref _identifier()
+        {
+            _skip();
+
+            if (_done() || !_identifier_start(_peek()))
+            {
+                throw _syntax_error{ _done() ? "unexpected end of line." : "unexpected `" + _text.substr(_position, 1).to_string()
+                    + "`." };
+            }
+
+            auto start = _position;
+            while (_position < _text.size() && _identifier_char(_text[_position]))
+            {
+                ++_position;
+            }
+
+            return _text.substr(start, _position - start);
+        }
+
+        // peeks at the next identifier without consuming it
+        boost::string_ref _next_identifier()
+        {
+            _skip();
+
+            if (_done() || !_identifier_start(_peek()))
+            {
+                return {};
+            }
+
+            auto position = _position;
+            auto ret = _identifier();
+            _position = position;
+            return ret;
+        }
+
+        const reaver::assembler::intel::mnemonic * _mnemonic(boost::string_ref word)
+        {
+            char buffer[16];
+            auto name = _lower(word, buffer);
+            return name.empty() ? nullptr : reaver::assembler::intel::find_mnemonic(name);
+        }
+
+        std::uint8_t _data_size(boost::string_ref word)
+        {
+            char buffer[16];
+            auto name = _lower(word, buffer);
+
+            if (name == "db")
+            {
+                return 1;
+            }
+
+            if (name == "dw")
+            {
+                return 2;
+            }
+
+            if (name == "dd")
+            {
+                return 4;
+            }
+
+            if (name == "dq")
+            {
+                return 8;
+            }
+
+            return 0;
+        }
+
+        std::uint8_t _reservation_size(boost::string_ref word)
+        {
+            char buffer[16];
+            auto name = _lower(word, buffer);
+
+            if (name == "resb")
+            {
+                return 1;
+            }
+
+            if (name == "resw")
+            {
+                return 2;
+            }
+
+            if (name == "resd")
+            {
+                return 4;
+            }
+
+            if (name == "resq")
+            {
+                return 8;
+            }
+
+            return 0;
+        }
+
+        // local labels (`.name`) belong to the last non-local label; their full names are only stored the first time they
+        // are seen
+        std::uint32_t _symbol(boost::string_ref name, bool definition = false)
+        {
+            if (name.size() > 1 && name[0] == '.' && name[1] != '.')
+            {
+                if (_scope.empty())
+                {
+                    throw _syntax_error{ "local label `" + name.to_string() + "` used before any non-local label." };
+                }
+
+                _local.assign(_scope.data(), _scope.size());
+                _local.append(name.data(), name.size());
+
+                auto ret = _symbols.find(_local);
+                return ret != reaver::assembler::no_symbol ? ret : _symbols.intern(_sources.store(_local));
+            }
+
+            if (definition && (name.size() < 2 || name[0] != '.' || name[1] != '.'))
+            {
+                _scope = name;
+            }
+
+            return _symbols.intern(name);
+        }
+
+        bool _directive(std::uint32_t location, boost::string_ref word, reaver::assembler::ast & output, bool bracketed = false)
+        {
+            char buffer[32];
+            auto name = _lower(word, buffer);
+
+            if (name == "bits")
+            {
+                auto bits = _expression();
+
+                if (!bits.constant() || (bits.value != 16 && bits.value != 32 && bits.value != 64))
+                {
+                    throw _syntax_error{ "invalid argument to `bits`; expected one of 16, 32 or 64." };
+                }
+
+                output.push(location, reaver::assembler::bits_directive{ static_cast<std::uint8_t>(bits.value) });
+                return true;
+            }
+
+            if (name == "section" || name == "segment")
+            {
+                reaver::assembler::section_directive directive{ _name(bracketed) };
+
+                while (!_next_identifier().empty())
+                {
+                    char attribute_buffer[16];
+                    auto given = _identifier();
+                    auto attribute = _lower(given, attribute_buffer);
+
+                    if (attribute == "nobits")
+                    {
+                        directive.nobits = true;
+                        continue;
+                    }
+
+                    if (attribute == "strings")
+                    {
+                        directive.strings = true;
+                        directive.entry_size = directive.entry_size ? directive.entry_size : 1;
+                        continue;
+                    }
+
+                    if (attribute != "merge")
+                    {
+                        throw _syntax_error{ "unknown section attribute `" + given.to_string() + "`." };
+                    }
+
+                    _expect('=');
+                    auto size = _expression();
+
+                    if (!size.constant() || (size.value != 1 && size.value != 2 && size.value != 4 && size.value != 8
+                        && size.value != 16 && size.value != 32))
+                    {
+                        throw _syntax_error{ "invalid argument to `merge`; expected one of 1, 2, 4, 8, 16 or 32." };
+                    }
+
+                    directive.entry_size = static_cast<std::uint8_t>(size.value);
+                }
+
+                output.push(location, directive);
+                return true;
+            }
+
+            if (name == "global")
+            {
+                do
+                {
+                    reaver::assembler::global_directive directive{ _symbol(_identifier()) };
+
+                    if (_accept(':'))
+                    {
+                        do
+                        {
+                            _symbol_attribute(directive);
+                        } while (!_next_identifier().empty());
+                    }
+
+                    output.push(location, directive);
+                } while (_accept(','));
+
+                return true;
+            }
+
+            // `size` is a fine name for a label, so it's only taken as a directive when followed by a name
+            if (name == "size" && !_next_identifier().empty())
+            {
+                auto symbol = _symbol(_identifier());
+                _expect(',');
+                output.push(location, reaver::assembler::size_directive{ symbol, _expression() });
+                return true;
+            }
+
+            if (name == "extern")
+            {
+                do
+                {
+                    output.push(location, reaver::assembler::extern_directive{ _symbol(_identifier()) });
+                } while (_accept(','));
+
+                return true;
+            }
+
+            if (name == "org")
+            {
+                auto address = _expression();
+
+                if (!address.constant())
+                {
+                    throw _syntax_error{ "invalid argument to `org`; expected a constant." };
+                }
+
+                output.push(location, reaver::assembler::org_directive{ static_cast<std::uint64_t>(address.value) });
+                return true;
+            }
+
+            if (_frame_directive(location, name, output))
+            {
+                return true;
+            }
+
+            if (name == "default")
+            {
+                char value_buffer[16];
+                auto value = _lower(_identifier(), value_buffer);
+
+                if (value != "rel" && value != "abs")
+                {
+                    throw _syntax_error{ "invalid argument to `default`; expected `rel` or `abs`." };
+                }
+
+                _default_rel = value == "rel";
+                return true;
+            }
+
+            if (!bracketed)
+            {
+                if (auto size = _data_size(name))
+                {
+                    _data(location, size, output);
+                    return true;
+                }
+
+                if (auto size = _reservation_size(name))
+                {
+                    _reservation(location, size, output);
+                    return true;
+                }
+            }
+
+            else
+            {
+                throw _syntax_error{ "unknown directive `" + word.to_string() + "`." };
+            }
+
+            return false;
+        }
+
+        // a type (`function` or `data`) or a visibility (`default`, `internal`, `hidden` or `protected`), in any order
+        void _symbol_attribute(reaver::assembler::global_directive & directive)
+        {
+            using reaver::assembler::symbol_types;
+            using reaver::assembler::symbol_visibilities;
+
+            char buffer[16];
+            auto given = _identifier();
+            auto attribute = _lower(given, buffer);
+
+            if (attribute == "function")
+            {
+                directive.type = symbol_types::function;
+            }
+
+            else if (attribute == "data" || attribute == "object")
+            {
+                directive.type = symbol_types::object;
+            }
+
+            else if (attribute == "default" || attribute == "internal" || attribute == "hidden" || attribute == "protected")
+            {
+                directive.visible = true;
+                directive.visibility = attribute == "default" ? symbol_visibilities::default_visibility
+                    : attribute == "internal" ? symbol_visibilities::internal_visibility
+                    : attribute == "hidden" ? symbol_visibilities::hidden_visibility : symbol_visibilities::protected_visibility;
+            }
+
+            else
+            {
+                throw _syntax_error{ "unknown symbol attribute `" + given.to_string() + "`; expected a type (`function` or `data`)"
+                    " or a visibility (`default`, `internal`, `hidden` or `protected`)." };
+            }
+        }
+
+        // `cfi_<name>`, also accepted with the leading dot gas uses; other words starting with `cfi_` are left for labels
+        bool _frame_directive(std::uint32_t location, boost::string_ref name, reaver::assembler::ast & output)
+        {
+            using kinds = reaver::assembler::cfi_directive::kinds;
+
+            static const struct
+            {
+                const char * name;
+                kinds kind;
+                bool reg;
+                bool offset;
+            } directives[] = {
+                { "startproc", kinds::startproc, false, false },
+                { "endproc", kinds::endproc, false, false },
+                { "def_cfa", kinds::def_cfa, true, true },
+                { "def_cfa_register", kinds::def_cfa_register, true, false },
+                { "def_cfa_offset", kinds::def_cfa_offset, false, true },
+                { "adjust_cfa_offset", kinds::adjust_cfa_offset, false, true },
+                { "offset", kinds::offset, true, true },
+                { "restore", kinds::restore, true, false },
+                { "remember_state", kinds::remember_state, false, false },
+                { "restore_state", kinds::restore_state, false, false }
+            };
+
+            if (name.starts_with('.'))
+            {
+                name.remove_prefix(1);
+            }
+
+            if (!name.starts_with("cfi_"))
+            {
+                return false;
+            }
+
+            name.remove_prefix(4);
+
+            for (const auto & d : directives)
+            {
+                if (name != d.name)
+                {
+                    continue;
+                }
+
+                reaver::assembler::cfi_directive directive{ d.kind, {}, 0 };
+
+                if (d.reg)
+                {
+                    auto reg = _find_register(_identifier());
+
+                    if (!reg)
+                    {
+                        throw _syntax_error{ "invalid argument to `cfi_" + name.to_string() + "`; expected a register." };
+                    }
+
+                    directive.reg = reg->id;
+                }
+
+                if (d.reg && d.offset)
+                {
+                    _expect(',');
+                }
+
+                if (d.offset)
+                {
+                    auto offset = _expression();
+
+                    if (!offset.constant())
+                    {
+                        throw _syntax_error{ "invalid argument to `cfi_" + name.to_string() + "`; expected a constant." };
+                    }
+
+                    directive.offset = offset.value;
+                }
+
+                output.push(location, directive);
+                return true;
+            }
+
+            return false;
+        }
+
+        // section names aren't restricted to identifiers
+        boost::string_ref _name(bool bracketed)
+        {
+            _skip();
+
+            auto start = _position;
+            while (_position < _text.size() && !std::isspace(static_cast<unsigned char>(_text[_position])) && _text[_position] != ';'
+                && (!bracketed || _text[_position] != ']'))
+            {
+                ++_position;
+            }
+
+            if (start == _position)
+            {
+                throw _syntax_error{ "expected a section name." };
+            }
+
+            return _text.substr(start, _position - start);
+        }
+
+        void _data(std::uint32_t location, std::uint8_t size, reaver::assembler::ast & output)
+        {
+            reaver::assembler::data ret{ size, {} };
+
+            do
+            {
+                _skip();
+
+                if (!_done() && (_peek() == '"' || _peek() == '\'' || _peek() == '`'))
+                {
+                    ret.items.push_back({ _string(), {} });
+                    continue;
+                }
+
+                ret.items.push_back({ {}, _expression() });
+            } while (_accept(','));
+
+            output.push(location, std::move(ret));
+        }
+
+        void _reservation(std::uint32_t location, std::uint8_t size, reaver::assembler::ast & output)
+        {
+            auto count = _expression();
 
-reaver::assembler::ast reaver::assembler::intel_parser::operator()(const std::vector<reaver::assembler::line> &) const
+            if (!count.constant() || count.value < 0 || count.value > std::numeric_limits<std::int64_t>::max() / size)
+            {
+                throw _syntax_error{ "invalid number of items to reserve; expected a non-negative constant." };
+            }
+
+            output.push(location, reaver::assembler::reservation{ size, static_cast<std::uint64_t>(count.value) });
+        }
+
+        boost::string_ref _string()
+        {
+            auto quote = _peek();
+            auto start = ++_position;
+
+            std::string escaped;
+
+            while (_position < _text.size() && _text[_position] != quote)
+            {
+                if (quote == '`' && _text[_position] == '\\' && _position + 1 < _text.size())
+                {
+                    escaped.append(_text.data() + start, _position - start);
+
+                    auto c = _text[++_position];
+                    ++_position;
+
+                    switch (c)
+                    {
+                        case 'n':
+                            escaped.push_back('\n');
+                            break;
+                        case 't':
+                            escaped.push_back('\t');
+                            break;
+                        case 'r':
+                            escaped.push_back('\r');
+                            break;
+                        case '0':
+                            escaped.push_back('\0');
+                            break;
+                        case 'x':
+                        {
+                            auto digits = _position;
+                            while (_position < _text.size() && _position - digits < 2 && std::isxdigit(static_cast<unsigned char>(
+                                _text[_position])))
+                            {
+                                ++_position;
+                            }
+
+                            if (digits == _position)
+                            {
+                                throw _syntax_error{ "invalid `\\x` escape sequence." };
+                            }
+
+                            escaped.push_back(static_cast<char>(std::stoi(_text.substr(digits, _position - digits).to_string(),
+                                nullptr, 16)));
+                            break;
+                        }
+                        default:
+                            escaped.push_back(c);
+                    }
+
+                    start = _position;
+                    continue;
+                }
+
+                ++_position;
+            }
+
+            if (_position >= _text.size())
+            {
+                throw _syntax_error{ "unterminated string." };
+            }
+
+            auto ret = _text.substr(start, _position - start);
+            ++_position;
+
+            if (quote == '`' && !escaped.empty())
+            {
+                escaped.append(ret.begin(), ret.end());
+                return _sources.store(escaped);
+            }
+
+            return ret;
+        }
+
+        std::int64_t _number()
+        {
+            auto start = _position;
+            while (_position < _text.size() && (std::isalnum(static_cast<unsigned char>(_text[_position])) || _text[_position] == '_'))
+            {
+                ++_position;
+            }
+
+            std::string digits;
+            for (auto c : _text.substr(start, _position - start))
+            {
+                if (c != '_')
+                {
+                    digits.push_back(std::tolower(static_cast<unsigned char>(c)));
+                }
+            }
+
+            // like nasm, when there's both a prefix (`0x`) and a suffix (`h`), the larger radix wins; the prefix letters are
+            // digits of hexadecimal numbers, so `0dh` is 13, while `0x1b` is 27; equal radices leave the whole thing decimal
+            auto radix = [](char c) -> unsigned
+            {
+                switch (c)
+                {
+                    case 'x': case 'h': return 16;
+                    case 'd': return 10;
+                    case 'o': case 'q': return 8;
+                    case 'b': case 'y': return 2;
+                    default: return 0;
+                }
+            };
+
+            auto prefix = digits.size() > 2 && digits[0] == '0' ? radix(digits[1]) : 0;
+            auto suffix = digits.size() > 1 ? radix(digits.back()) : 0;
+            unsigned base = 10;
+
+            if (prefix > suffix)
+            {
+                base = prefix;
+                digits.erase(0, 2);
+            }
+
+            else if (suffix > prefix)
+            {
+                base = suffix;
+                digits.pop_back();
+            }
+
+            std::uint64_t ret = 0;
+
+            for (auto c : digits)
+            {
+                unsigned digit = std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : c - 'a' + 10;
+
+                if (digit >= base || ret > (~std::uint64_t{} - digit) / base)
+                {
+                    throw _syntax_error{ "invalid number `" + _text.substr(start, _position - start).to_string() + "`." };
+                }
+
+                ret = ret * base + digit;
+            }
+
+            return static_cast<std::int64_t>(ret);
+        }
+
+        // character constants are little endian, like in nasm
+        std::int64_t _character()
+        {
+            auto string = _string();
+
+            if (string.size() > 8)
+            {
+                throw _syntax_error{ "character constant too long." };
+            }
+
+            std::uint64_t ret = 0;
+            for (std::size_t i = 0; i < string.size(); ++i)
+            {
+                ret |= static_cast<std::uint64_t>(static_cast<unsigned char>(string[i])) << (8 * i);
+            }
+
+            return static_cast<std::int64_t>(ret);
+        }
+
+        static reaver::assembler::expression _combine(reaver::assembler::expression lhs, char op, reaver::assembler::expression rhs)
+        {
+            std::uint64_t a = lhs.value, b = rhs.value;
+
+            if (op == '+' && (lhs.constant() || rhs.constant()))
+            {
+                return { lhs.constant() ? rhs.symbol : lhs.symbol, _wrap(a + b) };
+            }
+
+            if (op == '-' && rhs.constant())
+            {
+                return { lhs.symbol, _wrap(a - b) };
+            }
+
+            if (!lhs.constant() || !rhs.constant())
+            {
+                throw _syntax_error{ "expression is too complex to be relocated; only `symbol + constant` is supported." };
+            }
+
+            if ((op == '<' || op == '>') && b > 63)
+            {
+                throw _syntax_error{ "shift count out of range; expected 0 to 63." };
+            }
+
+            switch (op)
+            {
+                case '-': return _constant(_wrap(a - b));
+                case '*': return _constant(_wrap(a * b));
+                case '/': case '%':
+                    if (!b)
+                    {
+                        throw _syntax_error{ "division by zero." };
+                    }
+                    return _constant(_wrap(op == '/' ? a / b : a % b));
+                case '|': return _constant(_wrap(a | b));
+                case '^': return _constant(_wrap(a ^ b));
+                case '&': return _constant(_wrap(a & b));
+                case '<': return _constant(_wrap(a << b));
+                case '>': return _constant(_wrap(a >> b));
+            }
+
+            throw _syntax_error{ "invalid operator." };
+        }
+
+        reaver::assembler::expression _expression()
+        {
+            return _binary(0);
+        }
+
+        // precedence climbing; levels, loosest first: | ^ & (<< >>) (+ -) (* / %)
+        reaver::assembler::expression _binary(int level)
+        {
+            if (level == 6)
+            {
+                return _unary();
+            }
+
+            return _binary(level, _binary(level + 1));
+        }
+
+        reaver::assembler::expression _binary(int level, reaver::assembler::expression lhs)
+        {
+            while (auto op = _operator(level))
+            {
+                lhs = _combine(lhs, op, _binary(level + 1));
+            }
+
+            return lhs;
+        }
+
+        char _operator(int level)
+        {
+            static const char * operators[] = { "|", "^", "&", "<>", "+-", "*/%" };
+
+            _skip();
+
+            if (_done())
+            {
+                return 0;
+            }
+
+            auto c = _peek();
+
+            if (!std::strchr(operators[level], c))
+            {
+                return 0;
+            }
+
+            if (level == 3)
+            {
+                if (_position + 1 >= _text.size() || _text[_position + 1] != c)
+                {
+                    return 0;
+                }
+
+                ++_position;
+            }
+
+            ++_position;
+            return c;
+        }
+
+        reaver::assembler::expression _unary()
+        {
+            _skip();
+
+            if (_done())
+            {
+                throw _syntax_error{ "expected an expression." };
+            }
+
+            switch (_peek())
+            {
+                case '-':
+                {
+                    ++_position;
+                    auto value = _unary();
+                    if (!value.constant())
+                    {
+                        throw _syntax_error{ "cannot negate a symbol." };
+                    }
+                    return _constant(_wrap(0 - static_cast<std::uint64_t>(value.value)));
+                }
+
+                case '+':
+                    ++_position;
+                    return _unary();
+
+                case '~':
+                {
+                    ++_position;
+                    auto value = _unary();
+                    if (!value.constant())
+                    {
+                        throw _syntax_error{ "cannot negate a symbol." };
+                    }
+                    return _constant(~value.value);
+                }
+
+                case '(':
+                {
+                    ++_position;
+                    auto value = _expression();
+                    _expect(')');
+                    return value;
+                }
+
+                case '\'':
+                case '"':
+                case '`':
+                    return _constant(_character());
+            }
+
+            if (std::isdigit(static_cast<unsigned char>(_peek())))
+            {
+                return _constant(_number());
+            }
+
+            auto word = _identifier();
+
+            if (_find_register(word))
+            {
+                throw _syntax_error{ "unexpected register `" + word.to_string() + "` in an expression." };
+            }
+
+            return { _symbol(word), 0 };
+        }
+
+        void _instruction(std::uint32_t location, const reaver::assembler::intel::mnemonic * mnemonic, reaver::assembler::ast & output)
+        {
+            // prefixes written on the same line as the instruction they apply to
+            if (auto next = _mnemonic(_next_identifier()))
+            {
+                if (mnemonic->begin()->operand_count == 0)
+                {
+                    output.push(location, reaver::assembler::instruction{ mnemonic, 0, {} });
+                    _identifier();
+                    _instruction(location, next, output);
+                    return;
+                }
+            }
+
+            reaver::assembler::instruction ret;
+            ret.mnemonic = mnemonic;
+
+            _skip();
+
+            if (!_done())
+            {
+                do
+                {
+                    if (ret.operand_count == 3)
+                    {
+                        throw _syntax_error{ "too many operands." };
+                    }
+
+                    ret.operands[ret.operand_count++] = _operand();
+                } while (_accept(','));
+            }
+
+            _finish();
+            output.push(location, std::move(ret));
+        }
+
+        reaver::assembler::operand _operand()
+        {
+            reaver::assembler::operand ret;
+
+            bool far = false;
+            bool is_short = false;
+            bool near = false;
+
+            while (true)
+            {
+                auto word = _next_identifier();
+                char buffer[16];
+                auto name = _lower(word, buffer);
+
+                if (auto size = _size(name))
+                {
+                    ret.size = size;
+                }
+
+                else if (name == "far")
+                {
+                    far = true;
+                }
+
+                else if (name == "short")
+                {
+                    is_short = true;
+                    ret.strict = true;
+                }
+
+                else if (name == "near")
+                {
+                    near = true;
+                    ret.strict = true;
+                }
+
+                else if (name == "strict")
+                {
+                    ret.strict = true;
+                }
+
+                else
+                {
+                    break;
+                }
+
+                _identifier();
+            }
+
+            _skip();
+
+            if (!_done() && _peek() == '[')
+            {
+                ++_position;
+                _memory(ret);
+
+                if (far)
+                {
+                    ret.classes = m16_16 | m16_32 | m16_64;
+                }
+
+                return ret;
+            }
+
+            if (auto reg = _find_register(_next_identifier()))
+            {
+                _identifier();
+
+                if (!reg->classes)
+                {
+                    throw _syntax_error{ std::string{ "`" } + reg->name + "` cannot be used as an operand." };
+                }
+
+                ret.kind = reaver::assembler::operand::kinds::reg;
+                ret.reg = reg->id;
+                ret.classes = reg->classes;
+                return ret;
+            }
+
+            ret.value = _expression();
+
+            if (_accept(':'))
+            {
+                if (!ret.value.constant() || ret.value.value < 0 || ret.value.value > 0xFFFF)
+                {
+                    throw _syntax_error{ "invalid segment in a far pointer." };
+                }
+
+                ret.kind = reaver::assembler::operand::kinds::far_pointer;
+                ret.far_segment = static_cast<std::uint16_t>(ret.value.value);
+                ret.value = _expression();
+                ret.classes = ptr16_16 | ptr16_32;
+                return ret;
+            }
+
+            // references to symbols in branches always use relocations that the linker can send through the PLT, so `wrt ..plt`
+            // is only accepted for compatibility
+            auto wrt = _wrt();
+
+            if (!wrt.empty() && (wrt != "..plt" || ret.value.constant()))
+            {
+                throw _syntax_error{ "invalid `wrt " + wrt + "`; expected `..plt` after a symbol." };
+            }
+
+            ret.kind = reaver::assembler::operand::kinds::immediate;
+            ret.classes = _immediate_classes(ret.value, ret.size);
+
+            // whether the displacement fits is only known once the target's address is
+            if (is_short)
+            {
+                ret.classes = rel8;
+            }
+
+            else if (near)
+            {
+                ret.classes &= rel16 | rel32;
+            }
+
+            if (!ret.classes)
+            {
+                throw _syntax_error{ "immediate value does not fit in the requested size." };
+            }
+
+            return ret;
+        }
+
+        void _add_register(reaver::assembler::operand & op, const _register * reg, std::int64_t scale)
+        {
+            if (!(reg->classes & _address_registers) && reg->id.kind() != reaver::assembler::register_id::instruction_pointer)
+            {
+                throw _syntax_error{ std::string{ "`" } + reg->name + "` cannot be used in an effective address." };
+            }
+
+            if (scale != 1 && scale != 2 && scale != 4 && scale != 8)
+            {
+                throw _syntax_error{ "invalid index register scale." };
+            }
+
+            if (op.base && op.index)
+            {
+                throw _syntax_error{ "too many registers in an effective address." };
+            }
+
+            if (scale == 1 && !op.base)
+            {
+                op.base = reg->id;
+                return;
+            }
+
+            if (op.index)
+            {
+                if (scale != 1)
+                {
+                    throw _syntax_error{ "only one register in an effective address can be scaled." };
+                }
+
+                // `[a*2 + b]`
+                op.base = reg->id;
+                return;
+            }
+
+            if (reg->id.kind() == reaver::assembler::register_id::instruction_pointer)
+            {
+                throw _syntax_error{ "`rip` cannot be used as an index register." };
+            }
+
+            op.index = reg->id;
+            op.scale = static_cast<std::uint8_t>(scale);
+        }
+
+        void _memory(reaver::assembler::operand & op)
+        {
+            op.kind = reaver::assembler::operand::kinds::memory;
+            op.relative = _default_rel;
+            op.classes = _memory_classes(op.size);
+
+            char buffer[16];
+
+            while (true)
+            {
+                auto name = _lower(_next_identifier(), buffer);
+
+                if (name == "rel" || name == "abs")
+                {
+                    op.relative = name == "rel";
+                    _identifier();
+                    continue;
+                }
+
+                break;
+            }
+
+            {
+                auto position = _position;
+                auto reg = _find_register(_next_identifier());
+
+                if (reg && (reg->classes & sreg))
+                {
+                    _identifier();
+
+                    if (_accept(':'))
+                    {
+                        op.segment = reg->id;
+                    }
+
+                    else
+                    {
+                        _position = position;
+                    }
+                }
+            }
+
+            reaver::assembler::expression displacement;
+            char sign = '+';
+
+            if (_accept('-'))
+            {
+                sign = '-';
+            }
+
+            do
+            {
+                auto position = _position;
+
+                if (auto reg = _find_register(_next_identifier()))
+                {
+                    _identifier();
+
+                    if (sign == '-')
+                    {
+                        throw _syntax_error{ "registers cannot be subtracted in an effective address." };
+                    }
+
+                    std::int64_t scale = 1;
+                    if (_accept('*'))
+                    {
+                        auto value = _unary();
+                        if (!value.constant())
+                        {
+                            throw _syntax_error{ "invalid index register scale." };
+                        }
+                        scale = value.value;
+                    }
+
+                    _add_register(op, reg, scale);
+                    continue;
+                }
+
+                _position = position;
+
+                auto value = _unary();
+
+                if (_accept('*'))
+                {
+                    if (auto reg = _find_register(_next_identifier()))
+                    {
+                        _identifier();
+
+                        if (sign == '-' || !value.constant())
+                        {
+                            throw _syntax_error{ "invalid index register scale." };
+                        }
+
+                        _add_register(op, reg, value.value);
+                        continue;
+                    }
+
+                    value = _combine(value, '*', _unary());
+                }
+
+                // the rest of the multiplicative chain, if any
+                value = _binary(5, value);
+                displacement = _combine(displacement, sign, value);
+            } while ((sign = _accept('+') ? '+' : _accept('-') ? '-' : 0));
+
+            op.value = displacement;
+
+            auto wrt = _wrt();
+
+            if (wrt == "..got")
+            {
+                if (!op.relative || op.base || op.index || op.value.constant())
+                {
+                    throw _syntax_error{ "`wrt ..got` needs a rip relative reference to a symbol, like `[rel symbol wrt ..got]`." };
+                }
+
+                op.got = true;
+            }
+
+            else if (!wrt.empty())
+            {
+                throw _syntax_error{ "invalid `wrt " + wrt + "` in an effective address; expected `..got`." };
+            }
+
+            _expect(']');
+        }
+
+        // the special symbol after `wrt`, if there is one, in lower case; `..gotpcrel` is the same as `..got` in 64 bit code
+        std::string _wrt()
+        {
+            char buffer[16];
+
+            if (_lower(_next_identifier(), buffer) != "wrt")
+            {
+                return {};
+            }
+
+            _identifier();
+
+            auto given = _identifier();
+            auto name = _lower(given, buffer);
+
+            if (name.empty())
+            {
+                return given.to_string();
+            }
+
+            return name == "..gotpcrel" ? "..got" : name.to_string();
+        }
+
+        reaver::assembler::source_buffer & _sources;
+        reaver::assembler::symbol_table & _symbols;
+
+        boost::string_ref _text;
+        std::size_t _position = 0;
+
+        boost::string_ref _scope;
+        std::string _local;
+        bool _default_rel = false;
+    };
+}
+
+namespace
 {
-    _engine.push(exception(logger::crash) << "not implemented yet: " << __PRETTY_FUNCTION__);
-    throw std::move(_engine);
+    void _parse(_line_parser & parse, const reaver::assembler::line & l, reaver::assembler::ast & output, reaver::assembler::source_buffer
+        & sources, reaver::error_engine & engine)
+    {
+        try
+        {
+            parse(l, output);
+        }
+
+        catch (_syntax_error & e)
+        {
+            engine.push({
+                sources.include_chain(l.location)->exception(sources.column(l.location)),
+                reaver::exception(reaver::logger::error) << e.message
+            });
+        }
+    }
+}
+
+reaver::assembler::ast reaver::assembler::intel_parser::operator()(const std::vector<reaver::assembler::line> & lines) const
+{
+    ast ret;
+    _line_parser parse{ _front.sources(), _front.symbols() };
+
+    for (const auto & l : lines)
+    {
+        _parse(parse, l, ret, _front.sources(), _engine);
+    }
+
+    if (!_engine)
+    {
+        throw std::move(_engine);
+    }
+
+    return ret;
+}
+
+void reaver::assembler::intel_parser::operator()(utils::bounded_queue<line> & input, utils::bounded_queue<ast> & output) const
+{
+    ast fragment;
+    _line_parser parse{ _front.sources(), _front.symbols() };
+
+    while (auto l = input.pop())
+    {
+        _parse(parse, *l, fragment, _front.sources(), _engine);
+
+        if (fragment.size() >= _fragment_size)
+        {
+            output.push(std::move(fragment));
+            fragment = {};
+        }
+    }
+
+    if (!_engine)
+    {
+        throw std::move(_engine);
+    }
+
+    if (fragment.size())
+    {
+        output.push(std::move(fragment));
+    }
 }
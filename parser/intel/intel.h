@@ -33,15 +33,20 @@ namespace reaver
         class intel_parser : public parser
         {
         public:
-            intel_parser(const frontend &, error_engine & engine) : _engine{ engine }
+            intel_parser(const frontend & front, error_engine & engine) : _front{ front }, _engine{ engine }
             {
             }
 
             virtual ~intel_parser() {}
 
             virtual ast operator()(const std::vector<line> &) const override;
+            virtual void operator()(utils::bounded_queue<line> &, utils::bounded_queue<ast> &) const override;
 
         private:
+            // number of statements in a single fragment handed over to the generator
+            static constexpr std::size_t _fragment_size = 4096;
+
+            const frontend & _front;
             error_engine & _engine;
         };
     }
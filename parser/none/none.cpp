@@ -1,28 +0,0 @@
-/**
- * Reaver Project Assembler License
- *
- * Copyright © 2014 Michał "Griwes" Dominiak
- *
- * This software is provided 'as-is', without any express or implied
- * warranty. In no event will the authors be held liable for any damages
- * arising from the use of this software.
- *
- * Permission is granted to anyone to use this software for any purpose,
- * including commercial applications, and to alter it and redistribute it
- * freely, subject to the following restrictions:
- *
- * 1. The origin of this software must not be misrepresented; you must not
- *    claim that you wrote the original software. If you use this software
- *    in a product, an acknowledgment in the product documentation is required.
- * 2. Altered source versions must be plainly marked as such, and must not be
- *    misrepresented as being the original software.
- * 3. This notice may not be removed or altered from any source distribution.
- *
- **/
-
-#include "none.h"
-
-reaver::assembler::ast reaver::assembler::none_parser::operator()(const std::vector<reaver::assembler::line> &) const
-{
-    throw "NOT IMPLEMENTED YET NONE PARSER";
-}
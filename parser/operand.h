@@ -0,0 +1,133 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <cstdint>
+
+#include "register.h"
+#include "symbol_table.h"
+
+namespace reaver
+{
+    namespace assembler
+    {
+        // the classes an operand can satisfy; the parser computes the set for every operand once and opcode forms carry
+        // one class per slot, so selecting a form is just a handful of bitwise ands
+        namespace operand_classes
+        {
+            enum operand_class : std::uint64_t
+            {
+                none = 1ull << 0,
+                rel8 = 1ull << 1,
+                rel16 = 1ull << 2,
+                rel32 = 1ull << 3,
+                ptr16_16 = 1ull << 4,
+                ptr16_32 = 1ull << 5,
+                r8 = 1ull << 6,
+                r16 = 1ull << 7,
+                r32 = 1ull << 8,
+                r64 = 1ull << 9,
+                imm8 = 1ull << 10,
+                simm8 = 1ull << 11,
+                imm16 = 1ull << 12,
+                imm32 = 1ull << 13,
+                simm32 = 1ull << 14,
+                imm64 = 1ull << 15,
+                rm8 = 1ull << 16,
+                rm16 = 1ull << 17,
+                rm32 = 1ull << 18,
+                rm64 = 1ull << 19,
+                m = 1ull << 20,
+                m16_16 = 1ull << 21,
+                m16_32 = 1ull << 22,
+                m16_64 = 1ull << 23,
+                sreg = 1ull << 24,
+                creg = 1ull << 25,
+                dreg = 1ull << 26,
+                cr8 = 1ull << 27,
+                al = 1ull << 28,
+                ax = 1ull << 29,
+                eax = 1ull << 30,
+                rax = 1ull << 31,
+                dx = 1ull << 32,
+                r16m16 = 1ull << 33,
+                r32m16 = 1ull << 34,
+                ds = 1ull << 35,
+                es = 1ull << 36,
+                fs = 1ull << 37,
+                gs = 1ull << 38,
+                ss = 1ull << 39
+            };
+        }
+
+        using operand_classes::operand_class;
+
+        // `symbol + value`; either part may be missing
+        struct expression
+        {
+            bool constant() const
+            {
+                return symbol == no_symbol;
+            }
+
+            std::uint32_t symbol = no_symbol;
+            std::int64_t value = 0;
+        };
+
+        struct operand
+        {
+            enum class kinds : std::uint8_t
+            {
+                absent,
+                reg,
+                immediate,
+                memory,
+                far_pointer
+            };
+
+            kinds kind = kinds::absent;
+            // explicit size override in bytes, 0 if none was given
+            std::uint8_t size = 0;
+            // index scale for memory operands
+            std::uint8_t scale = 0;
+            // `[rel ...]`
+            bool relative = false;
+            // `[rel symbol wrt ..got]`; refers to the GOT entry of the symbol, not to the symbol itself
+            bool got = false;
+            // `short`, `near` or `strict`; the generator must not pick a different size for a branch
+            bool strict = false;
+
+            std::uint64_t classes = operand_classes::none;
+
+            // the register for reg operands; segment override, base and index for memory operands
+            register_id reg;
+            register_id segment;
+            register_id base;
+            register_id index;
+
+            // immediate value, memory displacement or far pointer offset
+            expression value;
+            std::uint16_t far_segment = 0;
+        };
+    }
+}
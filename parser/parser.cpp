@@ -25,13 +25,25 @@
 
 #include "parser.h"
 #include "intel/intel.h"
-#include "none/none.h"
 
 using reaver::style::colors;
 using reaver::style::styles;
 
 using namespace reaver::target;
 
+void reaver::assembler::parser::operator()(reaver::assembler::utils::bounded_queue<reaver::assembler::line> & input,
+    reaver::assembler::utils::bounded_queue<reaver::assembler::ast> & output) const
+{
+    std::vector<line> lines;
+
+    while (auto l = input.pop())
+    {
+        lines.push_back(std::move(*l));
+    }
+
+    output.push((*this)(lines));
+}
+
 namespace
 {
     void _mismatch(const reaver::assembler::frontend & front, reaver::error_engine & engine)
@@ -47,11 +59,6 @@ namespace
 std::unique_ptr<reaver::assembler::parser> reaver::assembler::create_parser(const reaver::assembler::frontend & front,
     error_engine & engine)
 {
-    if (front.preprocess_only())
-    {
-        return std::make_unique<none_parser>();
-    }
-
     if (front.syntax() == "intel")
     {
         if (front.target().arch() < arch::i386 || front.target().arch() > arch::x86_64)
@@ -28,6 +28,7 @@
 
 #include "../frontend/frontend.h"
 #include "../preprocessor/line.h"
+#include "../utils/bounded_queue.h"
 #include "ast.h"
 
 namespace reaver
@@ -44,6 +45,12 @@ namespace reaver
             virtual ~parser() {}
 
             virtual ast operator()(const std::vector<line> &) const = 0;
+
+            // streaming mode; pops lines until the input is closed and pushes ast fragments, but does not close the output
+            //
+            // the default implementation collects the whole input and falls back to the batch mode, which makes it emit
+            // exactly one fragment; parsers that can work on a line at a time should override it
+            virtual void operator()(utils::bounded_queue<line> &, utils::bounded_queue<ast> &) const;
         };
 
         std::unique_ptr<parser> create_parser(const frontend &, error_engine &);
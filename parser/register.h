@@ -0,0 +1,116 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <cstdint>
+
+namespace reaver
+{
+    namespace assembler
+    {
+        // everything the encoder needs to know about a register, packed into 16 bits:
+        //
+        //  bits 0-3    encoding number (0-15; bit 3 goes into REX.R/X/B)
+        //  bits 4-6    kind
+        //  bits 7-8    log2 of the size in bytes
+        //  bit 9       needs a REX prefix even without any of its bits set (spl, bpl, sil, dil)
+        //  bit 10      high byte register; can't be encoded together with any REX prefix (ah, ch, dh, bh)
+        class register_id
+        {
+        public:
+            enum kinds : std::uint8_t
+            {
+                none,
+                general,
+                segment,
+                control,
+                debug,
+                instruction_pointer
+            };
+
+            constexpr register_id() : _value{ 0 }
+            {
+            }
+
+            constexpr register_id(kinds kind, std::uint8_t size, std::uint8_t number, bool rex = false, bool high = false)
+                : _value{ static_cast<std::uint16_t>((number & 15) | (kind << 4) | (_log2(size) << 7) | (rex << 9) | (high << 10)) }
+            {
+            }
+
+            constexpr kinds kind() const
+            {
+                return static_cast<kinds>((_value >> 4) & 7);
+            }
+
+            // in bytes
+            constexpr std::uint8_t size() const
+            {
+                return 1 << ((_value >> 7) & 3);
+            }
+
+            constexpr std::uint8_t number() const
+            {
+                return _value & 15;
+            }
+
+            // needs REX.R, REX.X or REX.B, depending on where it's encoded
+            constexpr bool extended() const
+            {
+                return _value & 8;
+            }
+
+            constexpr bool requires_rex() const
+            {
+                return _value & (1 << 9);
+            }
+
+            constexpr bool high_byte() const
+            {
+                return _value & (1 << 10);
+            }
+
+            constexpr explicit operator bool() const
+            {
+                return kind() != none;
+            }
+
+            constexpr bool operator==(register_id other) const
+            {
+                return _value == other._value;
+            }
+
+            constexpr bool operator!=(register_id other) const
+            {
+                return _value != other._value;
+            }
+
+        private:
+            static constexpr std::uint16_t _log2(std::uint8_t size)
+            {
+                return size >= 8 ? 3 : size >= 4 ? 2 : size >= 2 ? 1 : 0;
+            }
+
+            std::uint16_t _value;
+        };
+    }
+}
@@ -0,0 +1,116 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include "symbol_table.h"
+
+namespace
+{
+    // FNV-1a
+    std::uint32_t _hash(boost::string_ref name)
+    {
+        std::uint32_t ret = 2166136261u;
+
+        for (auto c : name)
+        {
+            ret = (ret ^ static_cast<unsigned char>(c)) * 16777619u;
+        }
+
+        return ret;
+    }
+}
+
+std::uint32_t reaver::assembler::symbol_table::_find(boost::string_ref name, std::uint32_t hash) const
+{
+    if (_slots.empty())
+    {
+        return no_symbol;
+    }
+
+    auto mask = _slots.size() - 1;
+
+    for (auto slot = hash & mask; _slots[slot]; slot = (slot + 1) & mask)
+    {
+        const auto & entry = _entries[_slots[slot] - 1];
+
+        if (entry.hash == hash && entry.name == name)
+        {
+            return _slots[slot] - 1;
+        }
+    }
+
+    return no_symbol;
+}
+
+std::uint32_t reaver::assembler::symbol_table::find(boost::string_ref name) const
+{
+    return _find(name, _hash(name));
+}
+
+std::uint32_t reaver::assembler::symbol_table::intern(boost::string_ref name)
+{
+    auto hash = _hash(name);
+    auto ret = _find(name, hash);
+
+    if (ret != no_symbol)
+    {
+        return ret;
+    }
+
+    if ((_entries.size() + 1) * 2 > _slots.size())
+    {
+        _grow();
+    }
+
+    _entries.push_back({ name, hash });
+
+    auto mask = _slots.size() - 1;
+    auto slot = hash & mask;
+
+    while (_slots[slot])
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    _slots[slot] = _entries.size();
+
+    return _entries.size() - 1;
+}
+
+// the stored hashes make rehashing a matter of reinserting the indices
+void reaver::assembler::symbol_table::_grow()
+{
+    _slots.assign(_slots.empty() ? 256 : _slots.size() * 2, 0);
+
+    auto mask = _slots.size() - 1;
+
+    for (std::uint32_t i = 0; i < _entries.size(); ++i)
+    {
+        auto slot = _entries[i].hash & mask;
+
+        while (_slots[slot])
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        _slots[slot] = i + 1;
+    }
+}
@@ -0,0 +1,103 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <boost/utility/string_ref.hpp>
+
+namespace reaver
+{
+    namespace assembler
+    {
+        // the index of "no symbol at all"
+        constexpr std::uint32_t no_symbol = std::numeric_limits<std::uint32_t>::max();
+
+        // what a symbol names, as given by `global name:function` or `global name:data`
+        enum class symbol_types : std::uint8_t
+        {
+            none,
+            function,
+            object
+        };
+
+        // who outside of the object can see a global symbol, as given by `global name:hidden` (or `--visibility`); the
+        // values are the ones of ELF
+        enum class symbol_visibilities : std::uint8_t
+        {
+            default_visibility,
+            internal_visibility,
+            hidden_visibility,
+            protected_visibility
+        };
+
+        // every symbol name of a run, interned; past the parser, symbols are only ever referred to by their dense indices,
+        // so anything that needs to be stored per symbol can be kept in a plain vector
+        //
+        // names are looked up through an open addressing index (linear probing over a power of two number of slots, kept at
+        // most half full); the names themselves aren't copied, so they must live as long as the table does
+        //
+        // not thread safe; the parser is the only stage that adds names, and the stages after it only look them up once
+        // the parser is done with its input
+        class symbol_table
+        {
+        public:
+            symbol_table() = default;
+            symbol_table(const symbol_table &) = delete;
+            symbol_table & operator=(const symbol_table &) = delete;
+
+            // returns the index of the name, adding it if it isn't there yet
+            std::uint32_t intern(boost::string_ref name);
+
+            // returns the index of the name, or `no_symbol`
+            std::uint32_t find(boost::string_ref name) const;
+
+            boost::string_ref name(std::uint32_t index) const
+            {
+                return _entries[index].name;
+            }
+
+            std::uint32_t size() const
+            {
+                return _entries.size();
+            }
+
+        private:
+            struct _entry
+            {
+                boost::string_ref name;
+                std::uint32_t hash;
+            };
+
+            std::uint32_t _find(boost::string_ref name, std::uint32_t hash) const;
+            void _grow();
+
+            std::vector<_entry> _entries;
+
+            // symbol index + 1; 0 marks an empty slot
+            std::vector<std::uint32_t> _slots;
+        };
+    }
+}
@@ -22,30 +22,31 @@
 
 #pragma once
 
-#include <string>
-#include <vector>
+#include <cstdint>
 
-#include "../utils/include_chain.h"
-#include "define_chain.h"
+#include <boost/utility/string_ref.hpp>
+
+#include "source_buffer.h"
 
 namespace reaver
 {
     namespace assembler
     {
+        // lines are produced by the million, so they don't own anything; see source_buffer for how the rest of the
+        // information (original text, line number, include chain, define expansions) is recovered for diagnostics
         struct line
         {
-            line(std::pair<std::string, class define_chain> pp, std::vector<std::string> orig, uint64_t number, std::shared_ptr<
-                utils::include_chain> inc) : preprocessed{ std::move(pp.first) }, original{ std::move(orig) }, number{ number },
-                include_chain{ std::move(inc) }, define_chain{ std::move(pp.second) }
+            line(boost::string_ref pp, std::uint32_t loc, std::uint32_t exp = no_expansion) : preprocessed{ pp }, location{ loc },
+                expansion{ exp }
             {
             }
 
-            std::string preprocessed;
-            std::vector<std::string> original;
-            uint64_t number;
+            // a view either into the source text itself (for lines the preprocessor didn't have to change) or into the
+            // source buffer's arena
+            boost::string_ref preprocessed;
 
-            std::shared_ptr<utils::include_chain> include_chain;
-            class define_chain define_chain;
+            std::uint32_t location;
+            std::uint32_t expansion;
         };
     }
 }
@@ -20,42 +20,66 @@
  *
  **/
 
+#include <algorithm>
+
 #include "nasm.h"
 
-std::vector<reaver::assembler::line> reaver::assembler::nasm_preprocessor::operator()() const
+void reaver::assembler::nasm_preprocessor::operator()(reaver::assembler::utils::bounded_queue<reaver::assembler::line> & output) const
 {
-    _include_stream(_front.input(), std::make_shared<utils::include_chain>(_front.input_name()));
-    return {};
+    _include_stream(_front.sources().add_file(_front.input_name(), std::move(_front.input())), output);
 }
 
-void reaver::assembler::nasm_preprocessor::_include_stream(std::istream & is, std::shared_ptr<reaver::assembler::utils::include_chain> ic) const
+void reaver::assembler::nasm_preprocessor::_include_stream(std::uint32_t base, reaver::assembler::utils::bounded_queue<
+    reaver::assembler::line> & output) const
 {
-    std::string buffer;
-    std::size_t current_line = 1;
+    auto & sources = _front.sources();
+    auto text = sources.text(base);
+
+    std::size_t position = 0;
 
-    auto chain = [&](){
-        auto i = std::make_shared<utils::include_chain>(*ic);
-        i->line = current_line;
-        return i;
+    auto next_line = [&](){
+        std::size_t end = std::find(text.begin() + position, text.end(), '\n') - text.begin();
+        auto ret = text.substr(position, end - position);
+        position = end + 1;
+        return ret;
     };
 
-    while (std::getline(is, buffer))
+    while (position < text.size())
     {
-        while (buffer.back() == '\\')
+        auto start = position;
+        auto physical = next_line();
+
+        // the common case: the line is handed over as a view into the source, without copying it
+        if (physical.empty() || physical.back() != '\\')
+        {
+            output.push({ physical, static_cast<std::uint32_t>(base + start) });
+            continue;
+        }
+
+        std::string buffer;
+
+        while (!physical.empty() && physical.back() == '\\')
         {
-            std::string b;
+            physical.remove_suffix(1);
+            buffer.append(physical.begin(), physical.end());
 
-            if (!std::getline(is,  b))
+            if (position >= text.size())
             {
+                auto location = static_cast<std::uint32_t>(base + position - 1);
+
                 _engine.push({
-                    chain()->exception(buffer.size()),
+                    sources.include_chain(location)->exception(sources.column(location)),
                     exception(logger::error) << "invalid `\\` at the end of file."
                 });
-                buffer.pop_back();
+
+                physical.clear();
+                break;
             }
 
-            buffer.append(b);
-            ++current_line;
+            physical = next_line();
         }
+
+        buffer.append(physical.begin(), physical.end());
+        output.push({ sources.store(buffer), static_cast<std::uint32_t>(base + start) });
     }
 }
@@ -42,13 +42,15 @@ namespace reaver
 
             virtual ~nasm_preprocessor() {}
 
-            virtual std::vector<line> operator()() const override;
+            using preprocessor::operator();
+
+            virtual void operator()(utils::bounded_queue<line> &) const override;
 
         private:
-            void _include_stream(std::istream &, std::shared_ptr<utils::include_chain>) const;
+            void _include_stream(std::uint32_t, utils::bounded_queue<line> &) const;
 
-            std::pair<std::string, define_chain> _apply_defines(std::string, std::shared_ptr<utils::include_chain>) const;
-            define_chain _apply_defines(std::vector<lexer::token> &, std::shared_ptr<utils::include_chain>) const;
+            std::pair<std::string, define_chain> _apply_defines(std::string, std::uint32_t) const;
+            define_chain _apply_defines(std::vector<lexer::token> &, std::uint32_t) const;
 
             const frontend & _front;
 
@@ -37,13 +37,12 @@ namespace reaver
 
             virtual ~none_preprocessor() {}
 
-            virtual std::vector<line> operator()() const override
+            using preprocessor::operator();
+
+            virtual void operator()(utils::bounded_queue<line> & output) const override
             {
-                // the following return is slowly turning into brace abomination... God bless C++11 uniform initialization
-                // - if it wasn't available, it would be an even worse monstrocity that would have to mention every type
-                // name used in this invocation, which would be even more horrible. brr.
-                return { { { { std::istreambuf_iterator<char>{ _front.input().rdbuf() }, std::istreambuf_iterator<char>{} },
-                    {} }, {}, 0, {} } };
+                auto base = _front.sources().add_file(_front.input_name(), std::move(_front.input()));
+                output.push({ _front.sources().text(base), base });
             }
 
         private:
@@ -29,6 +29,22 @@
 using reaver::style::colors;
 using reaver::style::styles;
 
+std::vector<reaver::assembler::line> reaver::assembler::preprocessor::operator()() const
+{
+    utils::bounded_queue<line> queue;
+    (*this)(queue);
+    queue.close();
+
+    std::vector<line> ret;
+
+    while (auto l = queue.pop())
+    {
+        ret.push_back(std::move(*l));
+    }
+
+    return ret;
+}
+
 std::unique_ptr<reaver::assembler::preprocessor> reaver::assembler::create_preprocessor(const reaver::assembler::frontend & front,
     error_engine & engine)
 {
@@ -28,6 +28,7 @@
 #include <reaver/error.h>
 
 #include "../frontend/frontend.h"
+#include "../utils/bounded_queue.h"
 #include "line.h"
 
 namespace reaver
@@ -39,7 +40,11 @@ namespace reaver
         public:
             virtual ~preprocessor() {}
 
-            virtual std::vector<line> operator()() const = 0;
+            // batch mode; a compatibility wrapper around the streaming mode
+            std::vector<line> operator()() const;
+
+            // streaming mode; pushes lines into the queue as they are produced, but does not close it
+            virtual void operator()(utils::bounded_queue<line> &) const = 0;
         };
 
         std::unique_ptr<preprocessor> create_preprocessor(const frontend &, error_engine &);
@@ -0,0 +1,175 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include <algorithm>
+
+#include <reaver/exception.h>
+
+#include "source_buffer.h"
+
+std::uint32_t reaver::assembler::source_buffer::add_file(const std::string & name, reaver::assembler::utils::mapped_file contents,
+    std::uint32_t included_from)
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+
+    auto it = _files.find(name);
+
+    if (it == _files.end())
+    {
+        auto view = contents.contents();
+        it = _files.emplace(name, _file{ std::move(contents), view, {} }).first;
+    }
+
+    return _add(it, included_from);
+}
+
+std::uint32_t reaver::assembler::source_buffer::add_file(const std::string & name, boost::string_ref contents, std::uint32_t included_from)
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+
+    auto it = _files.find(name);
+
+    if (it == _files.end())
+    {
+        it = _files.emplace(name, _file{ {}, _arena.store(contents), {} }).first;
+    }
+
+    return _add(it, included_from);
+}
+
+std::uint32_t reaver::assembler::source_buffer::_add(std::map<std::string, _file>::const_iterator file, std::uint32_t included_from)
+{
+    if (file->second.contents.size() >= no_location - _next)
+    {
+        throw exception(logger::crash) << "source too large: locations exhausted while including `" << file->first << "`.";
+    }
+
+    _inclusions.push_back({ _next, included_from, file });
+    _next += file->second.contents.size() + 1;
+
+    return _inclusions.back().base;
+}
+
+const reaver::assembler::source_buffer::_inclusion & reaver::assembler::source_buffer::_find(std::uint32_t location) const
+{
+    auto it = std::upper_bound(_inclusions.begin(), _inclusions.end(), location, [](std::uint32_t loc, const _inclusion & inc)
+    {
+        return loc < inc.base;
+    });
+
+    if (location == no_location || it == _inclusions.begin())
+    {
+        throw exception(logger::crash) << "invalid source location; consider this an internal error.";
+    }
+
+    return *--it;
+}
+
+boost::string_ref reaver::assembler::source_buffer::text(std::uint32_t location) const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+
+    const auto & inclusion = _find(location);
+    return inclusion.file->second.contents.substr(location - inclusion.base);
+}
+
+std::string reaver::assembler::source_buffer::file_name(std::uint32_t location) const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+
+    return _find(location).file->first;
+}
+
+std::uint64_t reaver::assembler::source_buffer::_line_number(const _inclusion & inclusion, std::uint32_t location) const
+{
+    const auto & file = inclusion.file->second;
+
+    if (file.line_starts.empty())
+    {
+        file.line_starts.push_back(0);
+
+        for (std::uint32_t i = 0; i < file.contents.size(); ++i)
+        {
+            if (file.contents[i] == '\n')
+            {
+                file.line_starts.push_back(i + 1);
+            }
+        }
+    }
+
+    return std::upper_bound(file.line_starts.begin(), file.line_starts.end(), location - inclusion.base) - file.line_starts.begin();
+}
+
+std::uint64_t reaver::assembler::source_buffer::line_number(std::uint32_t location) const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+
+    return _line_number(_find(location), location);
+}
+
+std::uint64_t reaver::assembler::source_buffer::column(std::uint32_t location) const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+
+    const auto & inclusion = _find(location);
+    auto line = _line_number(inclusion, location);
+
+    return location - inclusion.base - inclusion.file->second.line_starts[line - 1];
+}
+
+std::shared_ptr<reaver::assembler::utils::include_chain> reaver::assembler::source_buffer::include_chain(std::uint32_t location) const
+{
+    std::shared_ptr<utils::include_chain> up;
+    std::string name;
+    std::uint64_t line;
+
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+
+        const auto & inclusion = _find(location);
+        name = inclusion.file->first;
+        line = _line_number(inclusion, location);
+        location = inclusion.included_from;
+    }
+
+    if (location != no_location)
+    {
+        up = include_chain(location);
+    }
+
+    return std::make_shared<utils::include_chain>(std::move(name), std::move(up), line);
+}
+
+std::vector<std::string> reaver::assembler::source_buffer::original(std::uint32_t location) const
+{
+    auto rest = text(location);
+    std::vector<std::string> ret;
+
+    do
+    {
+        auto end = std::min(rest.find('\n'), rest.size());
+        ret.emplace_back(rest.begin(), rest.begin() + end);
+        rest.remove_prefix(std::min(end + 1, rest.size()));
+    } while (!ret.back().empty() && ret.back().back() == '\\' && !rest.empty());
+
+    return ret;
+}
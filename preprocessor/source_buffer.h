@@ -0,0 +1,127 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+
+#include <boost/utility/string_ref.hpp>
+
+#include "../utils/arena.h"
+#include "../utils/include_chain.h"
+#include "../utils/mapped_file.h"
+#include "define_chain.h"
+
+namespace reaver
+{
+    namespace assembler
+    {
+        constexpr std::uint32_t no_location = ~std::uint32_t{};
+        constexpr std::uint32_t no_expansion = ~std::uint32_t{};
+
+        // all the source text of a single run
+        //
+        // every inclusion of a file is given a range of 32 bit locations, one per byte of the file (plus one for its end),
+        // so a location identifies both the file (and the include chain leading to it) and the position within it; file
+        // contents are interned, so including a file again doesn't read it again, and mapped files are kept mapped (and
+        // viewed, not copied) until the end of the run
+        //
+        // lines refer to the text by views and to the rest by a location, so that the line number, the original text and
+        // the include chain only have to be reconstructed when a diagnostic is printed
+        class source_buffer
+        {
+        public:
+            source_buffer() = default;
+            source_buffer(const source_buffer &) = delete;
+            source_buffer & operator=(const source_buffer &) = delete;
+
+            // both return the location of the first byte of the inclusion; the first one takes over the file, the second one
+            // copies the text into the arena
+            std::uint32_t add_file(const std::string & name, utils::mapped_file contents, std::uint32_t included_from = no_location);
+            std::uint32_t add_file(const std::string & name, boost::string_ref contents, std::uint32_t included_from = no_location);
+
+            // the text of the inclusion containing the location, starting at it
+            boost::string_ref text(std::uint32_t location) const;
+
+            // for text that doesn't exist verbatim in any file, like continued lines joined together
+            boost::string_ref store(boost::string_ref str)
+            {
+                std::lock_guard<std::mutex> lock{ _mutex };
+                return _arena.store(str);
+            }
+
+            std::uint32_t add_expansion(define_chain chain)
+            {
+                std::lock_guard<std::mutex> lock{ _mutex };
+                _expansions.push_back(std::move(chain));
+                return _expansions.size() - 1;
+            }
+
+            const define_chain & expansion(std::uint32_t index) const
+            {
+                std::lock_guard<std::mutex> lock{ _mutex };
+                return _expansions.at(index);
+            }
+
+            std::string file_name(std::uint32_t location) const;
+            std::uint64_t line_number(std::uint32_t location) const;
+            std::uint64_t column(std::uint32_t location) const;
+            std::shared_ptr<utils::include_chain> include_chain(std::uint32_t location) const;
+
+            // the physical lines making up the logical line starting at the location
+            std::vector<std::string> original(std::uint32_t location) const;
+
+        private:
+            struct _file
+            {
+                utils::mapped_file mapping;
+                boost::string_ref contents;
+                mutable std::vector<std::uint32_t> line_starts;
+            };
+
+            struct _inclusion
+            {
+                std::uint32_t base;
+                std::uint32_t included_from;
+                std::map<std::string, _file>::const_iterator file;
+            };
+
+            std::uint32_t _add(std::map<std::string, _file>::const_iterator, std::uint32_t);
+            const _inclusion & _find(std::uint32_t) const;
+            std::uint64_t _line_number(const _inclusion &, std::uint32_t) const;
+
+            utils::arena _arena;
+
+            std::map<std::string, _file> _files;
+            std::vector<_inclusion> _inclusions;
+            std::uint32_t _next = 0;
+
+            std::deque<define_chain> _expansions;
+
+            mutable std::mutex _mutex;
+        };
+    }
+}
@@ -0,0 +1,14 @@
+; rasm: -g
+
+bits    64
+
+section .text
+global _start
+
+_start:
+    mov     ebx, 0
+    call    finish
+
+finish:
+    mov     eax, 1
+    int     0x80
@@ -0,0 +1,32 @@
+bits    64
+
+section .data
+
+marker: db 0x2a
+
+section .bss
+
+buffer: resb 64 * 1024 * 1024
+
+section .text
+global _start
+
+; the reserved space takes no room in the object, but is still there, zeroed and writable, once the program is loaded
+_start:
+    mov     ebx, 1
+    mov     al, [buffer + 64 * 1024 * 1024 - 1]
+    cmp     al, 0
+    jne     exit
+
+    mov     ebx, 2
+    mov     al, [marker]
+    mov     [buffer], al
+    mov     [buffer + 64 * 1024 * 1024 - 1], al
+    cmp     al, [buffer]
+    jne     exit
+
+    mov     ebx, 0
+
+exit:
+    mov     eax, 1
+    int     0x80
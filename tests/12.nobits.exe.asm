@@ -0,0 +1,51 @@
+bits    64
+
+; uninitialized sections given before the data, and one named by its attribute rather than by `.bss`, still end up after
+; the data once linked, while space reserved in the data itself is written out as zeros
+
+section .bss
+
+counters:   resq 2
+
+section .data
+
+first:  dq 0x1122334455667788
+gap:    resb 8
+last:   dq 7
+
+section .buffers nobits
+
+buffer: resb 32 * 1024 * 1024
+
+section .text
+global _start
+
+_start:
+    mov     ebx, 1
+    mov     rax, [counters + 8]
+    or      rax, [buffer + 32 * 1024 * 1024 - 8]
+    or      rax, [gap]
+    cmp     rax, 0
+    jne     exit
+
+    mov     ebx, 2
+    mov     rax, -1
+    mov     [counters], rax
+    mov     [counters + 8], rax
+    mov     [buffer], rax
+    mov     [buffer + 32 * 1024 * 1024 - 8], rax
+    mov     rax, [first]
+    mov     rcx, 0x1122334455667788
+    cmp     rax, rcx
+    jne     exit
+
+    mov     ebx, 3
+    mov     rax, [last]
+    cmp     rax, 7
+    jne     exit
+
+    mov     ebx, 0
+
+exit:
+    mov     eax, 1
+    int     0x80
@@ -0,0 +1,35 @@
+bits    64
+
+section .data
+
+; nasm-style numbers; with both a prefix and a suffix, the larger radix wins; constant arithmetic wraps around
+literals:   db 0dh, 0ah, 0bh, 0b0h, 0d0h, 0x1b, 0b101, 10h, 0d12, 12d, 17o, 0q17, 101b, 0y11
+            dq -0x8000000000000000, 0x7fffffffffffffff + 1, 0x100000000 * 0x100000000 + 5, 1 << 63, 3 - 5
+expected:   db 13, 10, 11, 0xb0, 0xd0, 27, 5, 16, 12, 12, 15, 15, 5, 3
+            dq 0x8000000000000000, 0x8000000000000000, 5, 0x8000000000000000, 0xfffffffffffffffe
+
+section .text
+global _start
+
+_start:
+    mov     esi, literals
+    mov     edi, expected
+    mov     ecx, 14 + 5 * 8
+    mov     ebx, 0
+
+compare:
+    mov     al, [rsi]
+    cmp     al, [rdi]
+    jne     fail
+    inc     rsi
+    inc     rdi
+    dec     ecx
+    jnz     compare
+    jmp     exit
+
+fail:
+    mov     ebx, 1
+
+exit:
+    mov     eax, 1
+    int     0x80
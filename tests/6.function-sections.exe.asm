@@ -0,0 +1,35 @@
+; rasm: --function-sections
+
+bits    64
+
+section .text
+global _start
+global difference
+
+_start:
+    call    difference
+    mov     ebx, eax
+
+    mov     eax, 1
+    int     0x80
+
+; the data in the middle must not cut `difference` in two; the rest of it, frame included, stays in `.text.difference`
+difference:
+    cfi_startproc
+    push    rbx
+    cfi_adjust_cfa_offset 8
+    cfi_offset rbx, -16
+    mov     ebx, 42
+
+section .rodata
+
+value:  dd 42
+
+section .text
+
+    mov     eax, [value]
+    sub     eax, ebx
+    pop     rbx
+    cfi_adjust_cfa_offset -8
+    ret
+    cfi_endproc
@@ -0,0 +1,86 @@
+bits    64
+
+section .text
+global _start
+
+; branches get the short form when their targets are close enough, and the near one otherwise; every branch below is
+; taken, and the size it ended up with is checked against the labels around it afterwards
+_start:
+    mov     ecx, 3
+
+forward:
+    jmp     forward_end
+forward_end:
+
+; 127 bytes to skip still fit in a short jump, 128 don't
+short_edge:
+    jmp     short_edge_end
+    resb    127
+short_edge_end:
+
+near_edge:
+    jmp     near_edge_end
+    resb    128
+near_edge_end:
+
+conditional:
+    cmp     ecx, 3
+    je      conditional_end
+conditional_end:
+
+near_conditional:
+    cmp     ecx, 3
+    je      near_conditional_end
+    resb    200
+near_conditional_end:
+
+backward:
+    dec     ecx
+    jnz     backward
+backward_end:
+
+    mov     ebx, 1
+    cmp     ecx, 0
+    jne     exit
+
+    mov     ebx, 2
+    mov     eax, forward_end
+    sub     eax, forward
+    cmp     eax, 2
+    jne     exit
+
+    mov     ebx, 3
+    mov     eax, short_edge_end
+    sub     eax, short_edge
+    cmp     eax, 2 + 127
+    jne     exit
+
+    mov     ebx, 4
+    mov     eax, near_edge_end
+    sub     eax, near_edge
+    cmp     eax, 5 + 128
+    jne     exit
+
+    mov     ebx, 5
+    mov     eax, conditional_end
+    sub     eax, conditional
+    cmp     eax, 3 + 2
+    jne     exit
+
+    mov     ebx, 6
+    mov     eax, near_conditional_end
+    sub     eax, near_conditional
+    cmp     eax, 3 + 6 + 200
+    jne     exit
+
+    mov     ebx, 7
+    mov     eax, backward_end
+    sub     eax, backward
+    cmp     eax, 2 + 2
+    jne     exit
+
+    mov     ebx, 0
+
+exit:
+    mov     eax, 1
+    int     0x80
@@ -0,0 +1,58 @@
+bits    64
+
+section .rodata.str strings
+
+greeting:   db "hello", 0
+other:      db "world", 0
+again:      db "hello", 0
+
+section .rodata.cst4 merge=4
+
+one:    dd 1
+two:    dd 2
+uno:    dd 1
+
+section .text
+global _start
+
+; identical entries of mergeable sections are folded into one, and labels on them, or inside them, follow the entry
+_start:
+    mov     ebx, 1
+    mov     eax, greeting
+    cmp     eax, again
+    jne     exit
+
+    mov     ebx, 2
+    mov     al, [again + 4]
+    cmp     al, 0x6f
+    jne     exit
+
+    mov     ebx, 3
+    mov     al, [other]
+    cmp     al, 0x77
+    jne     exit
+
+    mov     ebx, 4
+    mov     eax, one
+    cmp     eax, uno
+    jne     exit
+
+    mov     ebx, 5
+    mov     eax, [two]
+    cmp     eax, 2
+    jne     exit
+
+    mov     ebx, 6
+    mov     eax, uno
+    sub     eax, one
+    jne     exit
+    mov     eax, two
+    sub     eax, one
+    cmp     eax, 4
+    jne     exit
+
+    mov     ebx, 0
+
+exit:
+    mov     eax, 1
+    int     0x80
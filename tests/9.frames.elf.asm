@@ -0,0 +1,50 @@
+bits    64
+
+global _start
+extern backtrace
+
+section .bss
+
+frames: resq 4
+
+section .text
+
+; the unwinder can only get from `inner` back to `_start` by following the call frame information of `inner`, so the
+; second return address `backtrace` finds must be the one right after the call
+_start:
+    call    inner
+returned:
+    mov     ebx, 1
+    cmp     eax, 2
+    jb      exit
+
+    mov     ebx, 2
+    mov     rax, [frames + 8]
+    mov     rcx, returned
+    cmp     rax, rcx
+    jne     exit
+
+    mov     ebx, 0
+
+exit:
+    mov     eax, 1
+    int     0x80
+
+inner:
+    cfi_startproc
+    push    rbp
+    cfi_adjust_cfa_offset 8
+    cfi_offset rbp, -16
+    mov     rbp, rsp
+    cfi_def_cfa_register rbp
+    sub     rsp, 32
+
+    mov     edi, frames
+    mov     esi, 4
+    call    backtrace
+
+    mov     rsp, rbp
+    pop     rbp
+    cfi_def_cfa rsp, 8
+    ret
+    cfi_endproc
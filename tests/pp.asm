@@ -1,4 +1,4 @@
 %define foo
 %ifdef foo
-%include "2.helloworld.elf.asm"
+%include "2.helloworld.exe.asm"
 %endif
@@ -0,0 +1,91 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include <boost/utility/string_ref.hpp>
+
+namespace reaver
+{
+    namespace assembler
+    {
+        namespace utils
+        {
+            // a bump allocator for text that lives for the whole run; nothing is ever freed before the arena itself dies,
+            // and the memory never moves, so views into it can be freely passed between pipeline stages
+            //
+            // not thread safe; the arena of the source buffer is shared by the stages, and only ever allocated from with the
+            // buffer's lock held, in `source_buffer::store` and when a file is added
+            class arena
+            {
+            public:
+                arena(std::size_t chunk_size = 1024 * 1024) : _chunk_size{ chunk_size }
+                {
+                }
+
+                arena(const arena &) = delete;
+                arena & operator=(const arena &) = delete;
+
+                char * allocate(std::size_t size)
+                {
+                    if (size > _left)
+                    {
+                        // big requests get a chunk of their own, so that they don't waste the rest of the current one
+                        if (size > _chunk_size / 4)
+                        {
+                            _chunks.emplace_back(new char[size]);
+                            return _chunks.back().get();
+                        }
+
+                        _chunks.emplace_back(new char[_chunk_size]);
+                        _current = _chunks.back().get();
+                        _left = _chunk_size;
+                    }
+
+                    auto ret = _current;
+                    _current += size;
+                    _left -= size;
+
+                    return ret;
+                }
+
+                boost::string_ref store(boost::string_ref str)
+                {
+                    auto memory = allocate(str.size());
+                    std::copy(str.begin(), str.end(), memory);
+
+                    return { memory, str.size() };
+                }
+
+            private:
+                std::size_t _chunk_size;
+                std::vector<std::unique_ptr<char[]>> _chunks;
+                char * _current = nullptr;
+                std::size_t _left = 0;
+            };
+        }
+    }
+}
@@ -0,0 +1,162 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <iterator>
+#include <algorithm>
+
+#include <boost/optional.hpp>
+
+namespace reaver
+{
+    namespace assembler
+    {
+        namespace utils
+        {
+            class queue_aborted : public std::exception
+            {
+            public:
+                virtual const char * what() const noexcept override
+                {
+                    return "pipeline queue aborted.";
+                }
+            };
+
+            // a blocking queue connecting two pipelined stages; capacity of 0 means the queue is unbounded, which is what
+            // the batch compatibility wrappers use
+            //
+            // there is exactly one producer and one consumer; both of them move items in batches, so the lock is only taken
+            // once per batch, not once per line
+            //
+            // close() is called by the producer once it's done; abort() is called when either side fails, and makes both
+            // push() and pop() throw queue_aborted, so that a stage blocked on the queue can't outlive a failed neighbour
+            template<typename T>
+            class bounded_queue
+            {
+            public:
+                bounded_queue(std::size_t capacity = 0) : _capacity{ capacity }, _batch{ capacity ? (capacity + 7) / 8 : 256 }
+                {
+                }
+
+                bounded_queue(const bounded_queue &) = delete;
+                bounded_queue & operator=(const bounded_queue &) = delete;
+
+                void push(T value)
+                {
+                    _produced.push_back(std::move(value));
+
+                    if (_produced.size() >= _batch)
+                    {
+                        _flush();
+                    }
+                }
+
+                boost::optional<T> pop()
+                {
+                    if (_consumed.empty())
+                    {
+                        std::unique_lock<std::mutex> lock{ _mutex };
+
+                        _not_empty.wait(lock, [&](){ return _aborted || _closed || !_queue.empty(); });
+
+                        if (_aborted)
+                        {
+                            throw queue_aborted{};
+                        }
+
+                        if (_queue.empty())
+                        {
+                            return {};
+                        }
+
+                        std::swap(_queue, _consumed);
+                        _not_full.notify_one();
+                    }
+
+                    boost::optional<T> ret{ std::move(_consumed.front()) };
+                    _consumed.pop_front();
+
+                    return ret;
+                }
+
+                void close()
+                {
+                    _flush();
+
+                    std::lock_guard<std::mutex> lock{ _mutex };
+                    _closed = true;
+                    _not_empty.notify_one();
+                }
+
+                void abort()
+                {
+                    std::lock_guard<std::mutex> lock{ _mutex };
+                    _aborted = true;
+                    _not_empty.notify_all();
+                    _not_full.notify_all();
+                }
+
+            private:
+                void _flush()
+                {
+                    if (_produced.empty())
+                    {
+                        return;
+                    }
+
+                    std::unique_lock<std::mutex> lock{ _mutex };
+
+                    _not_full.wait(lock, [&](){ return _aborted || !_capacity || _queue.size() + _produced.size() <= _capacity
+                        || _queue.empty(); });
+
+                    if (_aborted)
+                    {
+                        throw queue_aborted{};
+                    }
+
+                    std::move(_produced.begin(), _produced.end(), std::back_inserter(_queue));
+                    _produced.clear();
+
+                    _not_empty.notify_one();
+                }
+
+                std::size_t _capacity;
+                std::size_t _batch;
+                bool _closed = false;
+                bool _aborted = false;
+
+                std::deque<T> _queue;
+                std::deque<T> _produced;
+                std::deque<T> _consumed;
+
+                std::mutex _mutex;
+                std::condition_variable _not_empty;
+                std::condition_variable _not_full;
+            };
+        }
+    }
+}
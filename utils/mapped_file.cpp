@@ -0,0 +1,112 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "mapped_file.h"
+
+reaver::assembler::utils::mapped_file::mapped_file(const std::string & path)
+{
+    int fd = path == "-" ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        return;
+    }
+
+    struct stat info;
+
+    // a mapping starts at the beginning of the file, so standard input is only mapped when nothing of it was read yet
+    if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0
+        && (fd != STDIN_FILENO || ::lseek(fd, 0, SEEK_CUR) == 0))
+    {
+        void * address = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (address != MAP_FAILED)
+        {
+            ::madvise(address, info.st_size, MADV_SEQUENTIAL);
+
+            _data = static_cast<const char *>(address);
+            _size = info.st_size;
+            _mapped = true;
+            _open = true;
+
+            if (fd != STDIN_FILENO)
+            {
+                ::close(fd);
+            }
+
+            return;
+        }
+    }
+
+    char chunk[64 * 1024];
+
+    while (true)
+    {
+        auto read = ::read(fd, chunk, sizeof(chunk));
+
+        if (read < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (read < 0)
+        {
+            if (fd != STDIN_FILENO)
+            {
+                ::close(fd);
+            }
+
+            return;
+        }
+
+        if (read == 0)
+        {
+            break;
+        }
+
+        _buffer.insert(_buffer.end(), chunk, chunk + read);
+    }
+
+    if (fd != STDIN_FILENO)
+    {
+        ::close(fd);
+    }
+
+    _data = _buffer.data();
+    _size = _buffer.size();
+    _open = true;
+}
+
+reaver::assembler::utils::mapped_file::~mapped_file()
+{
+    if (_mapped)
+    {
+        ::munmap(const_cast<char *>(_data), _size);
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/utility/string_ref.hpp>
+
+namespace reaver
+{
+    namespace assembler
+    {
+        namespace utils
+        {
+            // read-only contents of an input file
+            //
+            // regular files are mapped into memory, so that reading them costs no more than the page faults; anything that
+            // can't be mapped (pipes, terminals, `-` meaning the standard input) is read into a buffer instead
+            //
+            // like std::ifstream, failing to open doesn't throw; check the object itself afterwards
+            class mapped_file
+            {
+            public:
+                mapped_file()
+                {
+                }
+
+                mapped_file(const std::string & path);
+
+                mapped_file(mapped_file && other) noexcept : _data{ other._data }, _size{ other._size }, _mapped{ other._mapped },
+                    _open{ other._open }, _buffer{ std::move(other._buffer) }
+                {
+                    other._data = nullptr;
+                    other._size = 0;
+                    other._mapped = false;
+                    other._open = false;
+                }
+
+                mapped_file & operator=(mapped_file && other) noexcept
+                {
+                    mapped_file tmp{ std::move(other) };
+                    swap(tmp);
+
+                    return *this;
+                }
+
+                mapped_file(const mapped_file &) = delete;
+                mapped_file & operator=(const mapped_file &) = delete;
+
+                ~mapped_file();
+
+                explicit operator bool() const
+                {
+                    return _open;
+                }
+
+                bool mapped() const
+                {
+                    return _mapped;
+                }
+
+                boost::string_ref contents() const
+                {
+                    return { _data, _size };
+                }
+
+                void swap(mapped_file & other) noexcept
+                {
+                    std::swap(_data, other._data);
+                    std::swap(_size, other._size);
+                    std::swap(_mapped, other._mapped);
+                    std::swap(_open, other._open);
+                    _buffer.swap(other._buffer);
+                }
+
+            private:
+                const char * _data = nullptr;
+                std::size_t _size = 0;
+                bool _mapped = false;
+                bool _open = false;
+
+                // a vector, not a string, so that moving it never moves the characters themselves
+                std::vector<char> _buffer;
+            };
+        }
+    }
+}
@@ -0,0 +1,308 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <algorithm>
+#include <deque>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+
+#include "output_file.h"
+#include "thread_pool.h"
+
+namespace
+{
+    // below this, a mapping costs more than it saves
+    constexpr std::uint64_t _map_threshold = 1 << 20;
+
+    // the unit of work of the copy into a mapping; large parts are split, so that a single big section keeps all threads busy
+    constexpr std::size_t _piece_size = 256 * 1024;
+
+    void _apply(std::uint8_t * field, const reaver::assembler::utils::output_file::patch & patch)
+    {
+        for (std::uint8_t i = 0; i < patch.size; ++i)
+        {
+            field[i] = static_cast<std::uint8_t>(patch.value >> (8 * i));
+        }
+    }
+}
+
+reaver::assembler::utils::output_file::output_file(const std::string & path) : _path{ path }
+{
+    if (path == "-")
+    {
+        _fd = STDOUT_FILENO;
+        return;
+    }
+
+    // devices and the like are written as they are; renaming over them would replace them
+    struct stat info;
+
+    if (::stat(path.c_str(), &info) == 0 && !S_ISREG(info.st_mode))
+    {
+        _fd = ::open(path.c_str(), O_WRONLY | O_TRUNC);
+        return;
+    }
+
+    _temporary = path + ".XXXXXX";
+    _fd = ::mkstemp(&_temporary[0]);
+
+    if (_fd < 0)
+    {
+        _temporary.clear();
+    }
+}
+
+reaver::assembler::utils::output_file::~output_file()
+{
+    if (_fd > STDERR_FILENO)
+    {
+        ::close(_fd);
+    }
+
+    if (!_temporary.empty())
+    {
+        ::unlink(_temporary.c_str());
+    }
+}
+
+bool reaver::assembler::utils::output_file::commit(bool executable)
+{
+    if (_temporary.empty())
+    {
+        return true;
+    }
+
+    // mkstemp creates the file readable only by its owner; give it the permissions a newly created file would have
+    auto mask = ::umask(0);
+    ::umask(mask);
+
+    if (::fchmod(_fd, (executable ? 0777 : 0666) & ~mask) != 0 || ::rename(_temporary.c_str(), _path.c_str()) != 0)
+    {
+        return false;
+    }
+
+    _temporary.clear();
+    return true;
+}
+
+// only the temporary file is known to be written from its start; the standard output may be redirected to the end of
+// an existing file, or be a pipe
+bool reaver::assembler::utils::output_file::preallocate(std::uint64_t size)
+{
+    if (_temporary.empty() || !size)
+    {
+        return true;
+    }
+
+    auto error = ::posix_fallocate(_fd, 0, size);
+
+    // not every file system can reserve space; setting the size is still better than growing the file with every write
+    if (error == EINVAL || error == EOPNOTSUPP)
+    {
+        return ::ftruncate(_fd, size) == 0;
+    }
+
+    errno = error;
+    return !error;
+}
+
+bool reaver::assembler::utils::output_file::write(std::vector<iovec> parts, std::vector<patch> patches, std::size_t jobs)
+{
+    parts.erase(std::remove_if(parts.begin(), parts.end(), [](const iovec & part){ return !part.iov_len; }), parts.end());
+
+    std::uint64_t size = 0;
+
+    for (const auto & part : parts)
+    {
+        size += part.iov_len;
+    }
+
+    if (size >= _map_threshold && !_temporary.empty() && _map(parts, patches, size, jobs))
+    {
+        return true;
+    }
+
+    return _write(std::move(parts), std::move(patches));
+}
+
+bool reaver::assembler::utils::output_file::append(const void * data, std::size_t size)
+{
+    return _write({ { const_cast<void *>(data), size } }, {});
+}
+
+bool reaver::assembler::utils::output_file::copy(const std::string & path)
+{
+    auto source = ::open(path.c_str(), O_RDONLY);
+
+    if (source < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    auto ret = ::fstat(source, &info) == 0;
+
+#ifdef FICLONE
+    // a clone replaces the whole file, so it's only done to the temporary one
+    if (ret && !_temporary.empty() && ::ioctl(_fd, FICLONE, source) == 0)
+    {
+        ::close(source);
+        return true;
+    }
+#endif
+
+    for (off_t offset = 0; ret && offset < info.st_size; )
+    {
+        auto copied = ::sendfile(_fd, source, &offset, info.st_size - offset);
+        ret = copied > 0 || (copied < 0 && errno == EINTR);
+    }
+
+    auto error = errno;
+    ::close(source);
+    errno = error;
+
+    return ret;
+}
+
+bool reaver::assembler::utils::output_file::_map(const std::vector<iovec> & parts, const std::vector<patch> & patches,
+    std::uint64_t size, std::size_t jobs)
+{
+    if (::ftruncate(_fd, size) != 0)
+    {
+        return false;
+    }
+
+    auto address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+
+    if (address == MAP_FAILED)
+    {
+        return false;
+    }
+
+    auto data = static_cast<std::uint8_t *>(address);
+
+    struct piece
+    {
+        const std::uint8_t * source;
+        std::uint8_t * target;
+        std::size_t size;
+    };
+
+    std::vector<piece> pieces;
+    std::uint64_t offset = 0;
+
+    for (const auto & part : parts)
+    {
+        auto source = static_cast<const std::uint8_t *>(part.iov_base);
+
+        for (std::size_t done = 0; done < part.iov_len; done += _piece_size)
+        {
+            pieces.push_back({ source + done, data + offset + done, std::min(_piece_size, part.iov_len - done) });
+        }
+
+        offset += part.iov_len;
+    }
+
+    thread_pool pool{ std::max<std::size_t>(std::min(jobs, pieces.size()), 1) };
+    pool.run(pieces.size(), [&](std::size_t i){ std::memcpy(pieces[i].target, pieces[i].source, pieces[i].size); });
+
+    for (const auto & patch : patches)
+    {
+        _apply(data + patch.offset, patch);
+    }
+
+    // the data is in the page cache by now; a failure to unmap doesn't lose it
+    ::munmap(address, size);
+    return true;
+}
+
+// patches are applied to copies of the parts they fall into; a patch never spans two parts
+bool reaver::assembler::utils::output_file::_write(std::vector<iovec> parts, std::vector<patch> patches)
+{
+    std::sort(patches.begin(), patches.end(), [](const patch & lhs, const patch & rhs){ return lhs.offset < rhs.offset; });
+
+    std::deque<std::vector<std::uint8_t>> copies;
+    auto pending = patches.begin();
+    std::uint64_t offset = 0;
+
+    for (auto & part : parts)
+    {
+        auto end = offset + part.iov_len;
+
+        if (pending != patches.end() && pending->offset < end)
+        {
+            auto source = static_cast<const std::uint8_t *>(part.iov_base);
+            copies.emplace_back(source, source + part.iov_len);
+
+            for (; pending != patches.end() && pending->offset < end; ++pending)
+            {
+                _apply(copies.back().data() + (pending->offset - offset), *pending);
+            }
+
+            part.iov_base = copies.back().data();
+        }
+
+        offset = end;
+    }
+
+    auto next = parts.begin();
+
+    while (next != parts.end())
+    {
+        auto count = std::min<std::ptrdiff_t>(parts.end() - next, IOV_MAX);
+        auto written = ::writev(_fd, &*next, count);
+
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (written < 0)
+        {
+            return false;
+        }
+
+        // skip whatever was written, possibly ending in the middle of a part
+        while (next != parts.end() && static_cast<std::size_t>(written) >= next->iov_len)
+        {
+            written -= next->iov_len;
+            ++next;
+        }
+
+        if (written)
+        {
+            next->iov_base = static_cast<char *>(next->iov_base) + written;
+            next->iov_len -= written;
+        }
+    }
+
+    return true;
+}
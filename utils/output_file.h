@@ -0,0 +1,102 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sys/uio.h>
+
+namespace reaver
+{
+    namespace assembler
+    {
+        namespace utils
+        {
+            // an output file, described as a list of parts pointing at wherever they already are in memory, so nothing has
+            // to be gathered into a single buffer first
+            //
+            // small outputs are written with scatter-gather I/O; large ones going to a temporary file are mapped, and the
+            // parts are copied into the mapping from several threads. either way, fields that only get their final values at
+            // the very end (like the resolved fixups of a flat binary) are patched in place of the copied bytes, not in
+            // copies of the sections
+            //
+            // a regular file is written under a temporary name next to the final one, and only renamed into place by
+            // `commit()`, so a failed run never leaves a half-written output behind
+            //
+            // like mapped_file, failing doesn't throw; check the object and the results, and errno for the reason
+            class output_file
+            {
+            public:
+                // a little endian field of the output, overwritten once all the parts are in place
+                struct patch
+                {
+                    std::uint64_t offset;
+                    std::uint64_t value;
+                    std::uint8_t size;
+                };
+
+                // `-` means the standard output
+                output_file(const std::string & path);
+                ~output_file();
+
+                output_file(const output_file &) = delete;
+                output_file & operator=(const output_file &) = delete;
+
+                explicit operator bool() const
+                {
+                    return _fd >= 0;
+                }
+
+                // reserves the final size of the temporary file up front, so that it isn't grown write by write; other files
+                // (the standard output, devices) are written where they stand
+                bool preallocate(std::uint64_t size);
+
+                // writes all the parts, in order, and applies the patches; `jobs` is the number of threads that may copy
+                // into a mapping
+                bool write(std::vector<iovec> parts, std::vector<patch> patches = {}, std::size_t jobs = 1);
+
+                // appends a single run of bytes, for outputs produced piece by piece; never maps the file, since the final
+                // size isn't known
+                bool append(const void * data, std::size_t size);
+
+                // writes the contents of another file; the data is shared with it (reflinked) when the file system can do
+                // that, and copied inside the kernel otherwise
+                bool copy(const std::string & path);
+
+                // moves the written file into place; an executable is made runnable by everyone who can read it
+                bool commit(bool executable = false);
+
+            private:
+                bool _write(std::vector<iovec> parts, std::vector<patch> patches);
+                bool _map(const std::vector<iovec> & parts, const std::vector<patch> & patches, std::uint64_t size,
+                    std::size_t jobs);
+
+                int _fd = -1;
+                std::string _path;
+                std::string _temporary;
+            };
+        }
+    }
+}
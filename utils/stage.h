@@ -0,0 +1,100 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <thread>
+#include <exception>
+
+#include "bounded_queue.h"
+
+namespace reaver
+{
+    namespace assembler
+    {
+        namespace utils
+        {
+            // a single pipeline stage running on its own thread
+            //
+            // the queues passed to the constructor are the ones the stage reads from and writes to; if the stage fails, they
+            // are aborted (unblocking its neighbours) and the exception is rethrown from join()
+            //
+            // a stage stopped by an aborted queue aborts all of its queues too, so that the abort spreads along the whole
+            // pipeline, and no stage is left waiting on a queue nobody will ever close
+            class stage
+            {
+            public:
+                template<typename F, typename... Queues>
+                stage(F f, Queues &... queues) : _thread{ [this, f, &queues...]() mutable
+                    {
+                        try
+                        {
+                            f();
+                        }
+
+                        catch (queue_aborted &)
+                        {
+                            // some other stage failed; it is the one responsible for reporting the error, but the stages on
+                            // the other side of this one still need to be unblocked
+                            using expand = int[];
+                            (void)expand{ 0, (queues.abort(), 0)... };
+                        }
+
+                        catch (...)
+                        {
+                            _exception = std::current_exception();
+
+                            using expand = int[];
+                            (void)expand{ 0, (queues.abort(), 0)... };
+                        }
+                    } }
+                {
+                }
+
+                stage(const stage &) = delete;
+                stage & operator=(const stage &) = delete;
+
+                ~stage()
+                {
+                    if (_thread.joinable())
+                    {
+                        _thread.join();
+                    }
+                }
+
+                void join()
+                {
+                    _thread.join();
+
+                    if (_exception)
+                    {
+                        std::rethrow_exception(_exception);
+                    }
+                }
+
+            private:
+                std::exception_ptr _exception;
+                std::thread _thread;
+            };
+        }
+    }
+}
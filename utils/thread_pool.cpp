@@ -0,0 +1,180 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#include "thread_pool.h"
+
+reaver::assembler::utils::thread_pool::thread_pool(std::size_t threads)
+{
+    threads = threads ? threads : 1;
+
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        _queues.emplace_back(std::make_unique<_queue>());
+    }
+
+    for (std::size_t i = 1; i < threads; ++i)
+    {
+        _threads.emplace_back([this, i](){ _wait(i); });
+    }
+}
+
+reaver::assembler::utils::thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        _stopped = true;
+    }
+
+    _started.notify_all();
+
+    for (auto & thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+void reaver::assembler::utils::thread_pool::run(std::size_t count, std::function<void (std::size_t)> task)
+{
+    if (_threads.empty())
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            task(i);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+
+        _task = std::move(task);
+        _exception = nullptr;
+
+        for (std::size_t worker = 0; worker < _queues.size(); ++worker)
+        {
+            std::lock_guard<std::mutex> queue_lock{ _queues[worker]->mutex };
+
+            for (auto i = count * worker / _queues.size(); i < count * (worker + 1) / _queues.size(); ++i)
+            {
+                _queues[worker]->items.push_back(i);
+            }
+        }
+
+        _busy = _threads.size();
+        ++_batch;
+    }
+
+    _started.notify_all();
+    _work(0);
+
+    std::unique_lock<std::mutex> lock{ _mutex };
+    _finished.wait(lock, [&](){ return !_busy; });
+    _task = nullptr;
+
+    if (_exception)
+    {
+        std::rethrow_exception(_exception);
+    }
+}
+
+bool reaver::assembler::utils::thread_pool::_pop(std::size_t worker, std::size_t & item)
+{
+    {
+        auto & own = *_queues[worker];
+        std::lock_guard<std::mutex> lock{ own.mutex };
+
+        if (!own.items.empty())
+        {
+            item = own.items.front();
+            own.items.pop_front();
+            return true;
+        }
+    }
+
+    for (std::size_t i = 1; i < _queues.size(); ++i)
+    {
+        auto & victim = *_queues[(worker + i) % _queues.size()];
+        std::lock_guard<std::mutex> lock{ victim.mutex };
+
+        if (!victim.items.empty())
+        {
+            item = victim.items.back();
+            victim.items.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void reaver::assembler::utils::thread_pool::_work(std::size_t worker)
+{
+    std::size_t item;
+
+    while (_pop(worker, item))
+    {
+        try
+        {
+            _task(item);
+        }
+
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock{ _mutex };
+
+            if (!_exception)
+            {
+                _exception = std::current_exception();
+            }
+        }
+    }
+}
+
+void reaver::assembler::utils::thread_pool::_wait(std::size_t worker)
+{
+    std::size_t batch = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock{ _mutex };
+            _started.wait(lock, [&](){ return _stopped || _batch != batch; });
+
+            if (_stopped)
+            {
+                return;
+            }
+
+            batch = _batch;
+        }
+
+        _work(worker);
+
+        std::lock_guard<std::mutex> lock{ _mutex };
+
+        if (!--_busy)
+        {
+            _finished.notify_all();
+        }
+    }
+}
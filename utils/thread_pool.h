@@ -0,0 +1,91 @@
+/**
+ * Reaver Project Assembler License
+ *
+ * Copyright © 2014 Michał "Griwes" Dominiak
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation is required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+namespace reaver
+{
+    namespace assembler
+    {
+        namespace utils
+        {
+            // a fixed set of threads running batches of indexed tasks
+            //
+            // every thread (including the one calling `run()`) starts with a contiguous block of the indices of a batch,
+            // takes them from the front of its own block, and once it runs out, steals from the back of the others'; that
+            // keeps every thread on neighbouring tasks for as long as possible, and still evens out uneven tasks
+            class thread_pool
+            {
+            public:
+                // `threads` counts the calling thread, so a pool of 1 runs everything in `run()` itself
+                thread_pool(std::size_t threads);
+                ~thread_pool();
+
+                thread_pool(const thread_pool &) = delete;
+                thread_pool & operator=(const thread_pool &) = delete;
+
+                // calls `task(i)` for every i in [0, count) and returns once all of them are done; if any of them throws,
+                // the first exception is rethrown after the rest are done
+                void run(std::size_t count, std::function<void (std::size_t)> task);
+
+                std::size_t size() const
+                {
+                    return _queues.size();
+                }
+
+            private:
+                struct _queue
+                {
+                    std::mutex mutex;
+                    std::deque<std::size_t> items;
+                };
+
+                bool _pop(std::size_t worker, std::size_t & item);
+                void _work(std::size_t worker);
+                void _wait(std::size_t worker);
+
+                std::vector<std::unique_ptr<_queue>> _queues;
+                std::vector<std::thread> _threads;
+
+                std::mutex _mutex;
+                std::condition_variable _started;
+                std::condition_variable _finished;
+
+                std::function<void (std::size_t)> _task;
+                std::size_t _batch = 0;
+                std::size_t _busy = 0;
+                bool _stopped = false;
+                std::exception_ptr _exception;
+            };
+        }
+    }
+}